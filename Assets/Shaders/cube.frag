@@ -3,15 +3,54 @@
 out vec4 FragColor;
 
 in vec2 TexCoord;
-in float vLight;
+flat in float TexLayer;
+in float vSkyLight;
+in vec3 vBlockLight;
+in vec3 vLightPos;
+flat in float vSkyShade;
+in float vAO;
 in float viewDistance;
 
-uniform sampler2D ourTexture;
+uniform sampler2DArray ourTexture;
+// Brightness of sky light by the time of day, 1 - noon
+uniform float dayLight;
+// Light levels of the chunk packed as in Chunk::light, read instead of vertex light when enabled.
+// Padded by a block of the neighbors, so texture x is block z + 1 and texture z is block x + 1
+uniform bool isLightTextureEnabled;
+uniform usampler3D lightTexture;
 uniform vec3 lightPos;
 uniform vec3 viewPos;
 
+// Brightness of a light level, each level is a fifth dimmer than the one above
+float getLevelLight(float level) {
+    return level <= 0.0 ? 0.0 : pow(0.8, 15.0 - level);
+}
+
+// Red, green, blue and sky light of the block at a chunk position, blocks above the chunk are open to the sky
+vec4 getTextureLight(vec3 position) {
+    ivec3 block = ivec3(floor(position));
+    uint levels = 0u;
+    if (block.y >= 128) {
+        levels = 15u << 12u;
+    } else if (block.y >= 0) {
+        levels = texelFetch(lightTexture, ivec3(block.z + 1, block.y, block.x + 1), 0).r;
+    }
+    return vec4(
+        getLevelLight(float(levels & 15u)), getLevelLight(float(levels >> 4u & 15u)),
+        getLevelLight(float(levels >> 8u & 15u)), getLevelLight(float(levels >> 12u))
+    );
+}
+
 void main() {
-    vec4 rgba = texture(ourTexture, TexCoord);
+    vec3 blockLight = vBlockLight;
+    float skyLight = vSkyLight;
+    if (isLightTextureEnabled) {
+        vec4 textureLight = getTextureLight(vLightPos);
+        blockLight = textureLight.rgb;
+        skyLight = textureLight.a * vSkyShade;
+    }
+
+    vec4 rgba = texture(ourTexture, vec3(TexCoord, TexLayer));
     vec3 color = vec3(rgba.x, rgba.y, rgba.z);
 
     float fogMaxDist = 70.0;
@@ -23,7 +62,8 @@ void main() {
     (fogMaxDist - fogMinDist);
     fogFactor = clamp(fogFactor, 0.0, 1.0);
 
-    vec3 result = mix(color, fogColor, 1.0 - fogFactor) * vLight;
+    vec3 light = min(vec3(1.0), skyLight * dayLight + blockLight) * vAO;
+    vec3 result = mix(color, fogColor, 1.0 - fogFactor) * light;
 
     FragColor = vec4(result, 1.0);
 }
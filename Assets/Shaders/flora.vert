@@ -1,24 +1,51 @@
 #version 330 core
 
-layout (location = 0) in vec3 aPos;
-layout (location = 1) in vec3 aNormal;
-layout (location = 2) in vec2 aTexCoord;
-layout (location = 3) in float aLight;
+// Packed plant, one per instance, see ChunkVertex
+layout (location = 0) in uvec2 aData;
 
 out vec2 TexCoord;
+flat out float TexLayer;
 out vec3 FragPos;
-out float vLight;
+out float vSkyLight;
+out vec3 vBlockLight;
+out vec3 vLightPos;
+flat out float vSkyShade;
 out float viewDistance;
 
 uniform vec3 pos;
 uniform mat4 view;
 uniform mat4 projection;
 
+const vec2 cornerTexCoords[4] = vec2[](vec2(0, 0), vec2(1, 0), vec2(1, 1), vec2(0, 1));
+
+// Cross mesh shared by all plants, two diagonal quads indexed by QuadIndexBuffer
+const vec3 crossVertices[8] = vec3[](
+    vec3(0, 0, 0), vec3(1, 0, 1), vec3(1, 1, 1), vec3(0, 1, 0),
+    vec3(1, 0, 0), vec3(0, 0, 1), vec3(0, 1, 1), vec3(1, 1, 0)
+);
+
+// Brightness of a light level, each level is a fifth dimmer than the one above
+float getLevelLight(float level) {
+    return level <= 0.0 ? 0.0 : pow(0.8, 15.0 - level);
+}
+
+// Quarter levels of a light channel: 0 - red, 1 - green, 2 - blue, 3 - sky
+float getChannelLevel(uint channel) {
+    return float(aData.y >> (channel * 6u) & 63u) / 4.0;
+}
+
 void main() {
-    TexCoord = aTexCoord;
-    vLight = aLight;
+    vec3 aPos = vec3(aData.x & 31u, (aData.x >> 5u) & 255u, (aData.x >> 13u) & 31u);
+    TexLayer = float(aData.y >> 24u);
+
+    TexCoord = cornerTexCoords[gl_VertexID % 4];
+    vSkyLight = getLevelLight(getChannelLevel(3u));
+    vBlockLight = vec3(getLevelLight(getChannelLevel(0u)), getLevelLight(getChannelLevel(1u)), getLevelLight(getChannelLevel(2u)));
+    // Plants take light of the block above, like the top face of a cube
+    vSkyShade = 1.0;
+    vLightPos = aPos + vec3(0.5, 1.5, 0.5);
 
-    vec4 absolutePos = vec4(pos + aPos, 1.0);
+    vec4 absolutePos = vec4(pos + aPos + crossVertices[gl_VertexID], 1.0);
     gl_Position = projection * view * absolutePos;
 
     vec4 viewPos = view * absolutePos;
@@ -1,13 +1,15 @@
 #version 330 core
 
-layout (location = 0) in vec3 aPos;
-layout (location = 1) in vec3 aNormal;
-layout (location = 2) in vec2 aTexCoord;
-layout (location = 3) in float aLight;
+// Packed vertex, see ChunkVertex
+layout (location = 0) in uvec2 aData;
 
 out vec2 TexCoord;
+flat out float TexLayer;
 out vec3 Normal;
-out float vLight;
+out float vSkyLight;
+out vec3 vBlockLight;
+out vec3 vLightPos;
+flat out float vSkyShade;
 out float viewDistance;
 
 uniform vec3 pos;
@@ -15,8 +17,36 @@ uniform mat4 view;
 uniform mat4 projection;
 uniform float time;
 
+// Width (U) and height (V) axes of each face, texture repeats over merged faces
+const ivec2 faceAxes[6] = ivec2[](
+    ivec2(0, 1), ivec2(0, 1), // front, back
+    ivec2(0, 2), ivec2(0, 2), // bottom, top
+    ivec2(2, 1), ivec2(2, 1)  // left, right
+);
+
+// Offset from a face to the middle of the block in front of it, light textures are read there
+const vec3 faceNormals[6] = vec3[](
+    vec3(0, 0, -1), vec3(0, 0, 1), // front, back
+    vec3(0, -1, 0), vec3(0, 1, 0), // bottom, top
+    vec3(-1, 0, 0), vec3(1, 0, 0)  // left, right
+);
+
+// Brightness of a light level, each level is a fifth dimmer than the one above
+float getLevelLight(float level) {
+    return level <= 0.0 ? 0.0 : pow(0.8, 15.0 - level);
+}
+
+// Quarter levels of a light channel: 0 - red, 1 - green, 2 - blue, 3 - sky
+float getChannelLevel(uint channel) {
+    return float(aData.y >> (channel * 6u) & 63u) / 4.0;
+}
+
 void main() {
-    TexCoord = aTexCoord;
+    vec3 aPos = vec3(aData.x & 31u, (aData.x >> 5u) & 255u, (aData.x >> 13u) & 31u);
+    TexLayer = float(aData.y >> 24u);
+    int face = int((aData.x >> 18u) & 7u);
+
+    TexCoord = vec2(aPos[faceAxes[face].x], aPos[faceAxes[face].y]);
 
     float waveStrength = 0.1;
     float waveSpeed = 1.1;
@@ -26,7 +56,12 @@ void main() {
     modifiedPos.y -= waveStrength;
     modifiedPos.y += waveStrength * sin(waveFrequency * aPos.x + time * waveSpeed);
 
-    vLight = aLight;
+    // Sides get half of the sky light, the time of day is applied per fragment
+    float skyShade = (face == 2 || face == 3) ? 1.0 : 0.5;
+    vSkyLight = getLevelLight(getChannelLevel(3u)) * skyShade;
+    vSkyShade = skyShade;
+    vLightPos = aPos + faceNormals[face] * 0.5;
+    vBlockLight = vec3(getLevelLight(getChannelLevel(0u)), getLevelLight(getChannelLevel(1u)), getLevelLight(getChannelLevel(2u)));
 
     vec4 absolutePos = vec4(pos + modifiedPos, 1.0);
     gl_Position = projection * view * absolutePos;
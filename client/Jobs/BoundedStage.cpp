@@ -0,0 +1,76 @@
+#include "BoundedStage.h"
+
+bool BoundedStage::enterOrPark(EnterAwaiter *awaiter) {
+    std::lock_guard lock(mutex);
+    if (depth < capacity) {
+        depth++;
+        return false;
+    }
+
+    awaiter->parkedAt = Clock::now();
+    awaiter->next = nullptr;
+    if (parkedTail) parkedTail->next = awaiter;
+    else parkedHead = awaiter;
+    parkedTail = awaiter;
+    parkedCount++;
+    return true;
+}
+
+void BoundedStage::forceEnter() {
+    std::lock_guard lock(mutex);
+    depth++;
+}
+
+void BoundedStage::leave() {
+    EnterAwaiter *awaiter;
+    {
+        std::lock_guard lock(mutex);
+        if (parkedHead == nullptr || depth > capacity) {
+            depth--;
+            return;
+        }
+
+        // Slot goes straight to the parked producer, depth stays the same
+        awaiter = static_cast<EnterAwaiter *>(parkedHead);
+        parkedHead = awaiter->next;
+        if (parkedHead == nullptr) parkedTail = nullptr;
+        parkedCount--;
+        stallTime += Clock::now() - awaiter->parkedAt;
+    }
+    awaiter->resumeOn->post(awaiter);
+}
+
+void BoundedStage::setProducerStalled(bool isStalled) {
+    std::lock_guard lock(mutex);
+    if (isStalled == isProducerStalled) return;
+
+    isProducerStalled = isStalled;
+    if (isStalled) producerStalledAt = Clock::now();
+    else stallTime += Clock::now() - producerStalledAt;
+}
+
+bool BoundedStage::isFull() {
+    std::lock_guard lock(mutex);
+    return depth >= capacity;
+}
+
+int BoundedStage::getDepth() {
+    std::lock_guard lock(mutex);
+    return depth;
+}
+
+int BoundedStage::getCapacity() const {
+    return capacity;
+}
+
+int BoundedStage::getParkedCount() {
+    std::lock_guard lock(mutex);
+    return parkedCount;
+}
+
+double BoundedStage::getStallMs() {
+    std::lock_guard lock(mutex);
+    auto total = stallTime;
+    if (isProducerStalled) total += Clock::now() - producerStalledAt;
+    return std::chrono::duration<double, std::milli>(total).count();
+}
@@ -0,0 +1,71 @@
+#ifndef BOUNDEDSTAGE_H
+#define BOUNDEDSTAGE_H
+
+#include <chrono>
+#include <mutex>
+
+#include "JobQueue.h"
+
+/**
+ * Bounded hand-off between two pipeline stages.
+ * Producers co_await enter() and stay parked while the stage is full,
+ * every leave() from the consumer side lets one parked producer in.
+ */
+class BoundedStage {
+    using Clock = std::chrono::steady_clock;
+public:
+    struct EnterAwaiter: JobQueue::Job {
+        BoundedStage *stage;
+        JobQueue *resumeOn;
+        Clock::time_point parkedAt;
+
+        EnterAwaiter(BoundedStage *stage, JobQueue *resumeOn): stage(stage), resumeOn(resumeOn) {}
+
+        bool await_ready() const noexcept { return false; }
+
+        // Returns false (continue without suspending) if a slot is free
+        bool await_suspend(std::coroutine_handle<> handle) {
+            this->handle = handle;
+            return stage->enterOrPark(this);
+        }
+
+        void await_resume() const noexcept {}
+    };
+
+    explicit BoundedStage(int capacity): capacity(capacity) {}
+
+    // Waits for a free slot, the task continues on resumeOn if it had to wait
+    EnterAwaiter enter(JobQueue *resumeOn) {
+        return EnterAwaiter(this, resumeOn);
+    }
+
+    // Takes a slot even if the stage is full, for work that must not wait
+    void forceEnter();
+
+    // Frees a slot, or hands it over to the oldest parked producer
+    void leave();
+
+    // For producers that poll instead of awaiting
+    void setProducerStalled(bool isStalled);
+
+    [[nodiscard]] bool isFull();
+    [[nodiscard]] int getDepth();
+    [[nodiscard]] int getCapacity() const;
+    [[nodiscard]] int getParkedCount();
+    [[nodiscard]] double getStallMs();
+private:
+    std::mutex mutex;
+    int capacity;
+    int depth = 0;
+    int parkedCount = 0;
+    JobQueue::Job *parkedHead = nullptr;
+    JobQueue::Job *parkedTail = nullptr;
+
+    bool isProducerStalled = false;
+    Clock::time_point producerStalledAt;
+    Clock::duration stallTime = Clock::duration::zero();
+
+    bool enterOrPark(EnterAwaiter *awaiter);
+};
+
+#endif //BOUNDEDSTAGE_H
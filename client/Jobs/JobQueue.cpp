@@ -0,0 +1,26 @@
+#include "JobQueue.h"
+
+void JobQueue::post(Job *job) {
+    count++;
+    jobs.push(job);
+}
+
+int JobQueue::runPending() {
+    // Several threads may drain at once, each one gets its own batch
+    Job *job = jobs.takeAll();
+
+    int resumed = 0;
+    while (job) {
+        // Resuming may free the frame holding the job
+        Job *next = job->next;
+        count--;
+        job->handle.resume();
+        job = next;
+        resumed++;
+    }
+    return resumed;
+}
+
+int JobQueue::size() const {
+    return count;
+}
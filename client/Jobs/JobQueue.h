@@ -0,0 +1,52 @@
+#ifndef JOBQUEUE_H
+#define JOBQUEUE_H
+
+#include <atomic>
+#include <coroutine>
+
+#include "MpscQueue.h"
+
+/**
+ * Executor for suspended tasks, drained by the threads that own it.
+ * Posting is lock-free, so any thread can hop a task onto it.
+ */
+class JobQueue {
+public:
+    // Lives inside the suspended coroutine frame, so queueing needs no allocation
+    struct Job {
+        std::coroutine_handle<> handle;
+        Job *next = nullptr;
+    };
+
+    struct ScheduleAwaiter: Job {
+        JobQueue *queue;
+
+        explicit ScheduleAwaiter(JobQueue *queue): queue(queue) {}
+
+        bool await_ready() const noexcept { return false; }
+
+        void await_suspend(std::coroutine_handle<> handle) {
+            this->handle = handle;
+            queue->post(this);
+        }
+
+        void await_resume() const noexcept {}
+    };
+
+    // co_await to continue the task on the thread draining this queue
+    ScheduleAwaiter schedule() {
+        return ScheduleAwaiter(this);
+    }
+
+    void post(Job *job);
+
+    // Resumes jobs queued before the call, returns count of resumed
+    int runPending();
+
+    [[nodiscard]] int size() const;
+private:
+    MpscQueue<Job> jobs;
+    std::atomic<int> count = 0;
+};
+
+#endif //JOBQUEUE_H
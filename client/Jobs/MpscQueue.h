@@ -0,0 +1,40 @@
+#ifndef MPSCQUEUE_H
+#define MPSCQUEUE_H
+
+#include <atomic>
+
+/**
+ * Lock-free intrusive queue, T must have a `T *next` field.
+ * Any thread can push, consumer takes everything at once, so there is no ABA.
+ */
+template <typename T>
+class MpscQueue {
+    std::atomic<T *> head = nullptr;
+public:
+    void push(T *node) {
+        T *oldHead = head.load(std::memory_order_relaxed);
+        do {
+            node->next = oldHead;
+        } while (!head.compare_exchange_weak(oldHead, node, std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    // Returns list of all pushed nodes, oldest first
+    T *takeAll() {
+        T *node = head.exchange(nullptr, std::memory_order_acquire);
+
+        T *reversed = nullptr;
+        while (node) {
+            T *next = node->next;
+            node->next = reversed;
+            reversed = node;
+            node = next;
+        }
+        return reversed;
+    }
+
+    [[nodiscard]] bool isEmpty() const {
+        return head.load(std::memory_order_relaxed) == nullptr;
+    }
+};
+
+#endif //MPSCQUEUE_H
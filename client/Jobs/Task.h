@@ -0,0 +1,32 @@
+#ifndef TASK_H
+#define TASK_H
+
+#include <coroutine>
+#include <exception>
+
+#include "TaskFramePool.h"
+
+/**
+ * Fire-and-forget coroutine, starts eagerly and frees its frame when finished.
+ * Frames come from TaskFramePool, so steps don't touch the heap.
+ */
+class Task {
+public:
+    struct promise_type {
+        Task get_return_object() { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+
+        static void *operator new(size_t size) {
+            return TaskFramePool::shared().allocate(size);
+        }
+
+        static void operator delete(void *frame, size_t size) {
+            TaskFramePool::shared().deallocate(frame, size);
+        }
+    };
+};
+
+#endif //TASK_H
@@ -0,0 +1,45 @@
+#include "TaskFramePool.h"
+
+TaskFramePool &TaskFramePool::shared() {
+    static TaskFramePool pool;
+    return pool;
+}
+
+void TaskFramePool::allocateSlab() {
+    auto slab = std::make_unique<std::byte[]>(FRAME_SIZE * FRAMES_PER_SLAB);
+    for (size_t i = 0; i < FRAMES_PER_SLAB; ++i) {
+        auto *frame = reinterpret_cast<FreeFrame *>(slab.get() + i * FRAME_SIZE);
+        frame->next = freeList;
+        freeList = frame;
+    }
+    slabs.push_back(std::move(slab));
+}
+
+void *TaskFramePool::allocate(size_t size) {
+    liveFrames++;
+    if (size > FRAME_SIZE) return ::operator new(size);
+
+    std::lock_guard lock(mutex);
+    if (freeList == nullptr) allocateSlab();
+
+    FreeFrame *frame = freeList;
+    freeList = frame->next;
+    return frame;
+}
+
+void TaskFramePool::deallocate(void *frame, size_t size) {
+    liveFrames--;
+    if (size > FRAME_SIZE) {
+        ::operator delete(frame);
+        return;
+    }
+
+    std::lock_guard lock(mutex);
+    auto *freeFrame = static_cast<FreeFrame *>(frame);
+    freeFrame->next = freeList;
+    freeList = freeFrame;
+}
+
+int TaskFramePool::getLiveFrames() const {
+    return liveFrames;
+}
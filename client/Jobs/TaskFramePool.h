@@ -0,0 +1,37 @@
+#ifndef TASKFRAMEPOOL_H
+#define TASKFRAMEPOOL_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/**
+ * Free list of fixed size coroutine frames, reused between tasks
+ */
+class TaskFramePool {
+    struct FreeFrame {
+        FreeFrame *next;
+    };
+
+    std::mutex mutex;
+    FreeFrame *freeList = nullptr;
+    std::vector<std::unique_ptr<std::byte[]>> slabs;
+    std::atomic<int> liveFrames = 0;
+
+    void allocateSlab();
+public:
+    static constexpr size_t FRAME_SIZE = 512;
+    static constexpr size_t FRAMES_PER_SLAB = 64;
+
+    static TaskFramePool &shared();
+
+    // Frames bigger than FRAME_SIZE fall back to the global heap
+    void *allocate(size_t size);
+    void deallocate(void *frame, size_t size);
+
+    [[nodiscard]] int getLiveFrames() const;
+};
+
+#endif //TASKFRAMEPOOL_H
@@ -0,0 +1,83 @@
+#include "ChunkLightTexture.h"
+
+#include <vector>
+
+#include "../World/Chunk.h"
+
+ChunkLightTexture::~ChunkLightTexture() {
+    if (texture) glDeleteTextures(1, &texture);
+}
+
+size_t ChunkLightTexture::upload(Chunk *chunk, BlocksSource *blocksSource, uint8_t sections) {
+    if (texture == 0) {
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_3D, texture);
+        // Levels are read with texelFetch, filters only have to keep the texture complete
+        glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAX_LEVEL, 0);
+        glTexImage3D(GL_TEXTURE_3D, 0, GL_R16UI, LIGHT_TEXTURE_SIZE_XZ, CHUNK_SIZE_Y, LIGHT_TEXTURE_SIZE_XZ, 0,
+                     GL_RED_INTEGER, GL_UNSIGNED_SHORT, nullptr);
+        sections = CHUNK_ALL_SECTIONS;
+    } else {
+        glBindTexture(GL_TEXTURE_3D, texture);
+    }
+
+    // Chunks around for the padding, missing ones leave it dark
+    Chunk *neighbors[3][3];
+    for (int dx = -1; dx <= 1; ++dx) {
+        for (int dz = -1; dz <= 1; ++dz) {
+            neighbors[dx + 1][dz + 1] = dx == 0 && dz == 0
+                ? chunk
+                : blocksSource->findChunkByChunkPos(chunk->position + Vec3i(dx, 0, dz));
+        }
+    }
+
+    // Render thread only, reused between uploads
+    static std::vector<uint16_t> texels;
+    size_t uploadedBytes = 0;
+
+    // Runs of adjacent sections go in one call
+    int section = 0;
+    while (section < CHUNK_SECTIONS) {
+        if (!(sections & (1 << section))) {
+            section++;
+            continue;
+        }
+
+        int endSection = section;
+        while (endSection < CHUNK_SECTIONS && (sections & (1 << endSection))) endSection++;
+
+        int minY = section * CHUNK_SECTION_SIZE;
+        int height = (endSection - section) * CHUNK_SECTION_SIZE;
+        texels.resize(LIGHT_TEXTURE_SIZE_XZ * height * LIGHT_TEXTURE_SIZE_XZ);
+
+        for (int x = -LIGHT_TEXTURE_PADDING; x < CHUNK_SIZE_XZ + LIGHT_TEXTURE_PADDING; ++x) {
+            for (int z = -LIGHT_TEXTURE_PADDING; z < CHUNK_SIZE_XZ + LIGHT_TEXTURE_PADDING; ++z) {
+                int chunkX = x < 0 ? 0 : (x < CHUNK_SIZE_XZ ? 1 : 2);
+                int chunkZ = z < 0 ? 0 : (z < CHUNK_SIZE_XZ ? 1 : 2);
+                Chunk *source = neighbors[chunkX][chunkZ];
+                Vec3i local = Vec3i((x + CHUNK_SIZE_XZ) % CHUNK_SIZE_XZ, 0, (z + CHUNK_SIZE_XZ) % CHUNK_SIZE_XZ);
+
+                for (int y = 0; y < height; ++y) {
+                    local.y = minY + y;
+                    size_t index = ((x + LIGHT_TEXTURE_PADDING) * height + y) * LIGHT_TEXTURE_SIZE_XZ + z + LIGHT_TEXTURE_PADDING;
+                    texels[index] = source == nullptr ? 0 : source->getLightLevels(local);
+                }
+            }
+        }
+
+        glTexSubImage3D(GL_TEXTURE_3D, 0, 0, minY, 0, LIGHT_TEXTURE_SIZE_XZ, height, LIGHT_TEXTURE_SIZE_XZ,
+                        GL_RED_INTEGER, GL_UNSIGNED_SHORT, texels.data());
+        uploadedBytes += texels.size() * sizeof(uint16_t);
+        section = endSection;
+    }
+
+    return uploadedBytes;
+}
+
+void ChunkLightTexture::bind(int unit) const {
+    glActiveTexture(GL_TEXTURE0 + unit);
+    glBindTexture(GL_TEXTURE_3D, texture);
+    glActiveTexture(GL_TEXTURE0);
+}
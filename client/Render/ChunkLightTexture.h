@@ -0,0 +1,33 @@
+#ifndef CHUNKLIGHTTEXTURE_H
+#define CHUNKLIGHTTEXTURE_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "../GL/glad.h"
+#include "../constants.h"
+#include "../World/BlocksSource.h"
+
+class Chunk;
+
+// Texels of blocks around the chunk on each side, faces at the border read light of the block in front from them
+#define LIGHT_TEXTURE_PADDING 1
+#define LIGHT_TEXTURE_SIZE_XZ (CHUNK_SIZE_XZ + 2 * LIGHT_TEXTURE_PADDING)
+
+/**
+ * GPU side of chunk light: a 3D texture with levels packed as in Chunk::light, sampled by the chunk
+ * shaders instead of vertex light. Same order as Chunk::light, so texture x is block z and texture z is block x.
+ * Light edits upload their sections again, the mesh stays as it is
+ */
+class ChunkLightTexture {
+    GLuint texture = 0;
+public:
+    ~ChunkLightTexture();
+
+    // Uploads light of the sections, a new texture takes all of them. GL thread only. Returns uploaded bytes
+    size_t upload(Chunk *chunk, BlocksSource *blocksSource, uint8_t sections);
+
+    void bind(int unit) const;
+};
+
+#endif //CHUNKLIGHTTEXTURE_H
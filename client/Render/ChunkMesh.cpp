@@ -0,0 +1,215 @@
+#include "ChunkMesh.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "QuadIndexBuffer.h"
+
+// Plants are two quads, drawn with face culling off so both sides show
+#define FLORA_INSTANCE_INDICES 12
+
+static size_t getElementSizeBytes(int pass) {
+    return CHUNK_PASS_ELEMENT_VERTICES(pass) * sizeof(ChunkVertex);
+}
+
+// Room for a few edits before the section has to move
+static uint32_t getSlotCapacity(uint32_t elementCount) {
+    return elementCount == 0 ? 0 : elementCount + elementCount / 4 + 8;
+}
+
+ChunkMesh::~ChunkMesh() {
+    for (PassBuffer &buffer: passes) {
+        if (buffer.vao) glDeleteVertexArrays(1, &buffer.vao);
+        if (buffer.vbo) glDeleteBuffers(1, &buffer.vbo);
+    }
+}
+
+size_t ChunkMesh::apply(const BakedChunk *bakedChunk) {
+    for (int pass = 0; pass < CHUNK_PASS_COUNT; ++pass) {
+        applyPass(passes[pass], pass, bakedChunk);
+    }
+    return bakedChunk->getMeshSizeBytes();
+}
+
+void ChunkMesh::applyPass(PassBuffer &buffer, int pass, const BakedChunk *bakedChunk) {
+    // Sections that outgrew their slot move to the free tail
+    uint32_t tailElements = buffer.usedElements;
+    for (int section = 0; section < CHUNK_SECTIONS; ++section) {
+        if (!bakedChunk->hasSection(section)) continue;
+
+        uint32_t elementCount = bakedChunk->parts[section][pass].getElementCount();
+        if (elementCount > buffer.sections[section].capacityElements) tailElements += getSlotCapacity(elementCount);
+    }
+
+    if (tailElements > buffer.capacityElements) {
+        repack(buffer, pass, bakedChunk);
+        return;
+    }
+
+    for (int section = 0; section < CHUNK_SECTIONS; ++section) {
+        if (!bakedChunk->hasSection(section)) continue;
+
+        const BakedChunkPart &part = bakedChunk->parts[section][pass];
+        SectionSlot &slot = buffer.sections[section];
+        if (part.getElementCount() > slot.capacityElements) {
+            slot.firstElement = buffer.usedElements;
+            slot.capacityElements = getSlotCapacity(part.getElementCount());
+            buffer.usedElements += slot.capacityElements;
+        }
+
+        writeSection(buffer, section, pass, part);
+    }
+}
+
+void ChunkMesh::repack(PassBuffer &buffer, int pass, const BakedChunk *bakedChunk) {
+    SectionSlot slots[CHUNK_SECTIONS];
+    uint32_t totalElements = 0;
+    size_t elementSize = getElementSizeBytes(pass);
+
+    for (int section = 0; section < CHUNK_SECTIONS; ++section) {
+        const SectionSlot &oldSlot = buffer.sections[section];
+        uint32_t elementCount = bakedChunk->hasSection(section)
+            ? bakedChunk->parts[section][pass].getElementCount()
+            : oldSlot.faceFirstElements[6];
+
+        slots[section] = oldSlot;
+        slots[section].firstElement = totalElements;
+        slots[section].capacityElements = getSlotCapacity(elementCount);
+        totalElements += slots[section].capacityElements;
+    }
+
+    // Nothing to draw in this pass, e.g. no water around
+    if (totalElements == 0 && buffer.vbo == 0) return;
+
+    uint32_t capacityElements = totalElements + totalElements / 2;
+
+    GLuint vbo;
+    glGenBuffers(1, &vbo);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, vbo);
+    glBufferData(GL_COPY_WRITE_BUFFER, capacityElements * elementSize, nullptr, GL_DYNAMIC_DRAW);
+
+    // Keep untouched sections without a trip through the CPU
+    if (buffer.vbo) {
+        glBindBuffer(GL_COPY_READ_BUFFER, buffer.vbo);
+        for (int section = 0; section < CHUNK_SECTIONS; ++section) {
+            uint32_t elementCount = buffer.sections[section].faceFirstElements[6];
+            if (bakedChunk->hasSection(section) || elementCount == 0) continue;
+
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER,
+                                buffer.sections[section].firstElement * elementSize,
+                                slots[section].firstElement * elementSize,
+                                elementCount * elementSize);
+        }
+    }
+
+    if (buffer.vao == 0) glGenVertexArrays(1, &buffer.vao);
+
+    glBindVertexArray(buffer.vao);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+
+    // Quad pattern is the same for every chunk, the VAO keeps the shared buffer
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, QuadIndexBuffer::getBuffer());
+
+    glVertexAttribIPointer(0, 2, GL_UNSIGNED_INT, sizeof(ChunkVertex), (void *) 0);
+    glEnableVertexAttribArray(0);
+
+    // Plant vertex is per instance, the cross mesh comes from the vertex id
+    if (pass == CHUNK_PASS_FLORA) glVertexAttribDivisor(0, 1);
+
+    if (buffer.vbo) glDeleteBuffers(1, &buffer.vbo);
+
+    buffer.vbo = vbo;
+    buffer.capacityElements = capacityElements;
+    buffer.usedElements = totalElements;
+    std::copy(std::begin(slots), std::end(slots), std::begin(buffer.sections));
+
+    for (int section = 0; section < CHUNK_SECTIONS; ++section) {
+        if (bakedChunk->hasSection(section)) writeSection(buffer, section, pass, bakedChunk->parts[section][pass]);
+    }
+}
+
+void ChunkMesh::writeSection(PassBuffer &buffer, int section, int pass, const BakedChunkPart &part) {
+    SectionSlot &slot = buffer.sections[section];
+    std::copy(std::begin(part.faceFirstElements), std::end(part.faceFirstElements), std::begin(slot.faceFirstElements));
+
+    if (part.vertices.empty()) return;
+
+    glBindBuffer(GL_ARRAY_BUFFER, buffer.vbo);
+    glBufferSubData(GL_ARRAY_BUFFER, slot.firstElement * getElementSizeBytes(pass), part.getMeshSizeBytes(), part.vertices.data());
+}
+
+size_t ChunkMesh::draw(int pass, const int sectionFaceMasks[CHUNK_SECTIONS]) {
+    PassBuffer &buffer = passes[pass];
+    if (buffer.vbo == 0) return 0;
+
+    drawCounts.clear();
+    drawBaseVertices.clear();
+    size_t drawnQuads = 0;
+
+    for (int section = 0; section < CHUNK_SECTIONS; ++section) {
+        const SectionSlot &slot = buffer.sections[section];
+        int faceMask = sectionFaceMasks[section];
+
+        for (int face = 0; face < 6; ++face) {
+            if (!(faceMask & (1 << face))) continue;
+
+            // Neighbor face ranges in one command
+            int lastFace = face;
+            while (lastFace + 1 < 6 && (faceMask & (1 << (lastFace + 1)))) lastFace++;
+
+            uint32_t firstQuad = slot.firstElement + slot.faceFirstElements[face];
+            uint32_t quadCount = slot.faceFirstElements[lastFace + 1] - slot.faceFirstElements[face];
+
+            // 16-bit indices reach QUAD_INDEX_BUFFER_QUADS quads from the base vertex
+            for (uint32_t drawn = 0; drawn < quadCount; drawn += QUAD_INDEX_BUFFER_QUADS) {
+                uint32_t count = std::min<uint32_t>(quadCount - drawn, QUAD_INDEX_BUFFER_QUADS);
+                drawCounts.push_back(count * 6);
+                drawBaseVertices.push_back((firstQuad + drawn) * 4);
+            }
+
+            drawnQuads += quadCount;
+            face = lastFace;
+        }
+    }
+
+    if (drawCounts.empty()) return 0;
+
+    drawOffsets.assign(drawCounts.size(), nullptr);
+
+    glBindVertexArray(buffer.vao);
+    glMultiDrawElementsBaseVertex(GL_TRIANGLES, drawCounts.data(), GL_UNSIGNED_SHORT, drawOffsets.data(),
+                                  drawCounts.size(), drawBaseVertices.data());
+
+    return drawnQuads * 4;
+}
+
+size_t ChunkMesh::drawFlora(float density) {
+    PassBuffer &buffer = passes[CHUNK_PASS_FLORA];
+    if (buffer.vbo == 0 || density <= 0.0f) return 0;
+
+    glBindVertexArray(buffer.vao);
+    glBindBuffer(GL_ARRAY_BUFFER, buffer.vbo);
+
+    size_t drawnInstances = 0;
+    for (const SectionSlot &slot: buffer.sections) {
+        // Plants are shuffled by the builder, so any prefix is spread over the section
+        auto instanceCount = static_cast<GLsizei>(std::ceil(slot.faceFirstElements[6] * std::min(density, 1.0f)));
+        if (instanceCount == 0) continue;
+
+        // No base instance before GL 4.2, point the attribute at the slot instead
+        glVertexAttribIPointer(0, 2, GL_UNSIGNED_INT, sizeof(ChunkVertex), (void *) (slot.firstElement * sizeof(ChunkVertex)));
+        glDrawElementsInstanced(GL_TRIANGLES, FLORA_INSTANCE_INDICES, GL_UNSIGNED_SHORT, nullptr, instanceCount);
+
+        drawnInstances += instanceCount;
+    }
+
+    return drawnInstances * 8;
+}
+
+size_t ChunkMesh::getElementCount(int pass) const {
+    size_t elementCount = 0;
+    for (const SectionSlot &slot: passes[pass].sections) {
+        elementCount += slot.faceFirstElements[6];
+    }
+    return elementCount;
+}
@@ -0,0 +1,58 @@
+#ifndef CHUNKMESH_H
+#define CHUNKMESH_H
+
+#include <cstdint>
+#include <vector>
+
+#include "../GL/glad.h"
+#include "../World/BakedChunk.h"
+
+/**
+ * GPU side of a chunk: one vertex buffer per render pass, sub-allocated by sections,
+ * so rebaking a section rewrites only its slot
+ */
+class ChunkMesh {
+    struct SectionSlot {
+        uint32_t firstElement = 0;
+        uint32_t capacityElements = 0;
+        uint32_t faceFirstElements[7] = {}; // Relative to firstElement
+    };
+
+    struct PassBuffer {
+        GLuint vao = 0;
+        GLuint vbo = 0;
+        uint32_t capacityElements = 0;
+        uint32_t usedElements = 0; // Slots are taken from the start, a moved slot leaves a hole until repack
+        SectionSlot sections[CHUNK_SECTIONS];
+    };
+
+    PassBuffer passes[CHUNK_PASS_COUNT];
+
+    // Draw commands of the current pass, reused between draws
+    std::vector<GLsizei> drawCounts;
+    std::vector<GLint> drawBaseVertices;
+    std::vector<const void *> drawOffsets;
+
+    void applyPass(PassBuffer &buffer, int pass, const BakedChunk *bakedChunk);
+
+    // Moves all slots into a new buffer, sections of the bake get room for their new size
+    void repack(PassBuffer &buffer, int pass, const BakedChunk *bakedChunk);
+
+    void writeSection(PassBuffer &buffer, int section, int pass, const BakedChunkPart &part);
+public:
+    ~ChunkMesh();
+
+    // Uploads sections of the bake, GL thread only. Returns uploaded bytes
+    size_t apply(const BakedChunk *bakedChunk);
+
+    // Draws faces of a quad pass with their bit set in the section face mask, in one call. Returns count of drawn vertices
+    size_t draw(int pass, const int sectionFaceMasks[CHUNK_SECTIONS]);
+
+    // Draws plants of the flora pass as instances of the cross mesh, density 0..1 keeps a spread out part of them.
+    // Returns count of drawn vertices
+    size_t drawFlora(float density);
+
+    [[nodiscard]] size_t getElementCount(int pass) const;
+};
+
+#endif //CHUNKMESH_H
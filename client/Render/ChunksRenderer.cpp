@@ -1,5 +1,9 @@
 #include "ChunksRenderer.h"
 
+#include "ChunkMesh.h"
+#include "ChunkLightTexture.h"
+#include "../World/Mesher/ChunkMeshBuilder.h"
+
 std::array<Plane, 6> ChunksRenderer::extractFrustumPlanes(const glm::mat4 &matrix) {
     std::array<Plane, 6> planes;
 
@@ -45,6 +49,27 @@ bool ChunksRenderer::isChunkInFrustum(const std::array<Plane, 6> &frustumPlanes,
     return true;
 }
 
+void ChunksRenderer::getSectionVisibleFaces(const glm::vec3 &cameraPos, const glm::vec3 &chunkPos, int sectionFaces[CHUNK_SECTIONS]) {
+    for (int section = 0; section < CHUNK_SECTIONS; ++section) {
+        glm::vec3 sectionMin = chunkPos + glm::vec3(0, section * CHUNK_SECTION_SIZE, 0);
+        glm::vec3 sectionMax = sectionMin + glm::vec3(CHUNK_SIZE_XZ, CHUNK_SECTION_SIZE, CHUNK_SIZE_XZ);
+
+        // A face direction is seen only from the side its normal points to,
+        // so the camera has to be past the nearest plane of that direction
+        int faceMask = 0;
+        if (cameraPos.z < sectionMax.z) faceMask |= 1 << FACE_FRONT;
+        if (cameraPos.z > sectionMin.z) faceMask |= 1 << FACE_BACK;
+        if (cameraPos.y < sectionMax.y) faceMask |= 1 << FACE_BOTTOM;
+        if (cameraPos.y > sectionMin.y) faceMask |= 1 << FACE_TOP;
+        if (cameraPos.x < sectionMax.x) faceMask |= 1 << FACE_LEFT;
+        if (cameraPos.x > sectionMin.x) faceMask |= 1 << FACE_RIGHT;
+        sectionFaces[section] = faceMask;
+    }
+}
+
+// Texture unit of light textures, the blocks texture array stays on the first one
+#define LIGHT_TEXTURE_UNIT 1
+
 #define CUBE_MINUS_V -0.01f
 #define CUBE_PLUS_V 1.01f
 
@@ -87,8 +112,8 @@ static const GLfloat blockVertices[] = {
     CUBE_PLUS_V,CUBE_MINUS_V, CUBE_PLUS_V
 };
 
-ChunksRenderer::ChunksRenderer(std::unordered_map<BlockID, GLuint> glTextures, RuntimeConfig *runtimeConfig) {
-    this->glTextures = glTextures;
+ChunksRenderer::ChunksRenderer(GLuint blocksTextureArray, RuntimeConfig *runtimeConfig) {
+    this->blocksTextureArray = blocksTextureArray;
     this->runtimeConfig = runtimeConfig;
 
     glGenVertexArrays(1, &vaoSelection);
@@ -111,6 +136,75 @@ ChunksRenderer::ChunksRenderer(std::unordered_map<BlockID, GLuint> glTextures, R
     glEnableVertexAttribArray(0);
 }
 
+float ChunksRenderer::getFloraDensity(double distance) const {
+    double fullDensityDistance = runtimeConfig->floraFullDensityDistance;
+    double maxDistance = runtimeConfig->maxRenderingDistance * CHUNK_SIZE_XZ;
+    if (distance <= fullDensityDistance) return 1.0f;
+    if (fullDensityDistance >= maxDistance) return 1.0f;
+
+    return static_cast<float>(1.0 - (distance - fullDensityDistance) / (maxDistance - fullDensityDistance));
+}
+
+float ChunksRenderer::getDayLight() const {
+    // Sun turns by 15 degrees an hour. Full light from morning to evening, dim moonlight at night
+    float sunHeight = std::cos(glm::radians((runtimeConfig->timeOfDay - 12.0f) * 15.0f));
+    return std::clamp(0.5f + sunHeight, 0.15f, 1.0f);
+}
+
+void ChunksRenderer::uploadPendingMeshes(const std::vector<Chunk *> &chunks, Vec3i playerChunkPos) {
+    std::vector<std::pair<double, Chunk *>> pending;
+    for (const auto &chunk: chunks) {
+        if (chunk->getPendingBakedChunk() == nullptr || chunk->isNeedToUnload) continue;
+
+        pending.emplace_back(chunk->position.distanceTo(playerChunkPos), chunk);
+    }
+
+    std::sort(pending.begin(), pending.end(), [](const auto &a, const auto &b) {
+        return a.first < b.first;
+    });
+
+    size_t budgetBytes = static_cast<size_t>(runtimeConfig->uploadBudgetKb) * 1024;
+    size_t uploadedBytes = 0;
+    int pendingCount = 0;
+
+    for (const auto &[distance, chunk]: pending) {
+        // Always upload at least one chunk, so huge meshes can't stall forever
+        size_t meshSize = chunk->getPendingBakedChunk()->getMeshSizeBytes();
+        if (uploadedBytes > 0 && uploadedBytes + meshSize > budgetBytes) {
+            pendingCount++;
+            continue;
+        }
+
+        uploadedBytes += chunk->applyPendingBakedChunk();
+    }
+
+    lastCountOfUploadedBytes = uploadedBytes;
+    lastCountOfPendingUploads = pendingCount;
+}
+
+size_t ChunksRenderer::uploadLightTextures(const std::vector<Chunk *> &chunks, World *world) {
+    size_t uploadedBytes = 0;
+    for (const auto &chunk: chunks) {
+        if (chunk->getMesh() == nullptr || chunk->isNeedToUnload) continue;
+
+        uploadedBytes += chunk->applyLightTexture(world);
+    }
+    return uploadedBytes;
+}
+
+void ChunksRenderer::setLightSource(Shader *shader) const {
+    shader->setBool("isLightTextureEnabled", runtimeConfig->isLightTextureEnabled);
+    shader->setInt("lightTexture", LIGHT_TEXTURE_UNIT);
+}
+
+void ChunksRenderer::bindLightTexture(const Chunk *chunk) const {
+    if (!runtimeConfig->isLightTextureEnabled) return;
+
+    if (ChunkLightTexture *lightTexture = chunk->getLightTexture()) {
+        lightTexture->bind(LIGHT_TEXTURE_UNIT);
+    }
+}
+
 void ChunksRenderer::renderChunks(World *world, Shader *shader, Shader *waterShader, Shader *selectionShader, Shader *floraShader, Vec3i playerPos) {
     lastCountOfTotalVertices = 0;
 
@@ -121,20 +215,34 @@ void ChunksRenderer::renderChunks(World *world, Shader *shader, Shader *waterSha
     // Copy chunks array
     std::vector<Chunk *> chunks = world->chunks;
 
+    Vec3i playerChunkPos = {
+        playerPos.x / CHUNK_SIZE_XZ, 0,
+        playerPos.z / CHUNK_SIZE_XZ
+    };
+    uploadPendingMeshes(chunks, playerChunkPos);
+    if (runtimeConfig->isLightTextureEnabled) {
+        lastCountOfUploadedBytes += uploadLightTextures(chunks, world);
+    }
+
     glm::mat4 viewProjection = projection * world->player->getViewMatrix();
     glm::vec3 pos;
+    glm::vec3 cameraPos = world->player->getPosition();
 
     auto frustumPlanes = extractFrustumPlanes(viewProjection);
+    float dayLight = getDayLight();
 
     shader->use();
     shader->setMat4("view", world->player->getViewMatrix());
     shader->setMat4("projection", projection);
     shader->setVec3("lightPos", this->lightPos);
     shader->setVec3("viewPos", world->player->getPosition());
+    shader->setFloat("dayLight", dayLight);
+    setLightSource(shader);
 
     glDisable(GL_BLEND);
 
-    glBindTexture(GL_TEXTURE_2D, 1);
+    // Same for all passes, the layer comes with the vertex
+    glBindTexture(GL_TEXTURE_2D_ARRAY, this->blocksTextureArray);
 
     // Draw all solid & unload if needed
     for (const auto &chunk: chunks) {
@@ -143,18 +251,14 @@ void ChunksRenderer::renderChunks(World *world, Shader *shader, Shader *waterSha
             continue;
         }
 
-        Vec3i playerChunkPos = {
-            playerPos.x / CHUNK_SIZE_XZ, 0,
-            playerPos.z / CHUNK_SIZE_XZ
-        };
         double distance = (chunk->position).distanceTo(playerChunkPos);
         if (distance > (runtimeConfig->maxRenderingDistance * CHUNK_SIZE_XZ)) {
             continue;
         }
-        BakedChunk *bakedChunk = chunk->getBakedChunk();
+        ChunkMesh *mesh = chunk->getMesh();
 
         // Chunk is not baked yet?
-        if (bakedChunk == nullptr) continue;
+        if (mesh == nullptr) continue;
 
         pos.x = chunk->position.x * CHUNK_SIZE_XZ;
         pos.y = chunk->position.y * CHUNK_SIZE_Y;
@@ -168,18 +272,12 @@ void ChunksRenderer::renderChunks(World *world, Shader *shader, Shader *waterSha
             continue;
         }
 
-        for (auto &part: bakedChunk->chunkParts) {
-            if (!part.hasBuffered()) {
-                part.bufferMesh();
-            }
-            glBindVertexArray(part.vao);
-
-            shader->setVec3("pos", pos);
+        int sectionFaces[CHUNK_SECTIONS];
+        getSectionVisibleFaces(cameraPos, pos, sectionFaces);
 
-            glBindTexture(GL_TEXTURE_2D, this->glTextures[part.blockID]);
-            glDrawElements(GL_TRIANGLES, part.indices.size(), GL_UNSIGNED_INT, nullptr);
-            lastCountOfTotalVertices += part.vertices.size() / 9; // Verticles count
-        }
+        shader->setVec3("pos", pos);
+        bindLightTexture(chunk);
+        lastCountOfTotalVertices += mesh->draw(CHUNK_PASS_SOLID, sectionFaces); // Verticles count
     }
 
     // Copy actual chunks array
@@ -191,6 +289,8 @@ void ChunksRenderer::renderChunks(World *world, Shader *shader, Shader *waterSha
     waterShader->setVec3("lightPos", this->lightPos);
     waterShader->setVec3("viewPos", world->player->getPosition());
     waterShader->setFloat("time", SDL_GetTicks() / 1000.0f);
+    waterShader->setFloat("dayLight", dayLight);
+    setLightSource(waterShader);
 
     glEnable(GL_DEPTH_TEST);
     glDepthMask(GL_TRUE);
@@ -202,40 +302,39 @@ void ChunksRenderer::renderChunks(World *world, Shader *shader, Shader *waterSha
         if (distance > (runtimeConfig->maxRenderingDistance * CHUNK_SIZE_XZ)) {
             continue;
         }
-        BakedChunk *bakedChunk = chunk->getBakedChunk();
+        ChunkMesh *mesh = chunk->getMesh();
 
         // Chunk is not baked yet?
-        if (bakedChunk == nullptr) continue;;
+        if (mesh == nullptr) continue;
 
         pos.x = chunk->position.x * CHUNK_SIZE_XZ;
         pos.y = chunk->position.y * CHUNK_SIZE_Y;
         pos.z = chunk->position.z * CHUNK_SIZE_XZ;
 
-        // Draw not-solid
-        for (auto &part: bakedChunk->liquidChunkParts) {
-            if (!part.hasBuffered()) {
-                part.bufferMesh();
-            }
-            glBindVertexArray(part.vao);
-
-            waterShader->setVec3("pos", pos);
-            waterShader->setVec3("worldPos", pos);
+        int sectionFaces[CHUNK_SECTIONS];
+        getSectionVisibleFaces(cameraPos, pos, sectionFaces);
 
-            glBindTexture(GL_TEXTURE_2D, this->glTextures[part.blockID]);
-            glDrawElements(GL_TRIANGLES, part.indices.size(), GL_UNSIGNED_INT, nullptr);
-            lastCountOfTotalVertices += part.vertices.size() / 9; // Verticles count
-        }
+        // Draw not-solid
+        waterShader->setVec3("pos", pos);
+        waterShader->setVec3("worldPos", pos);
+        bindLightTexture(chunk);
+        lastCountOfTotalVertices += mesh->draw(CHUNK_PASS_LIQUID, sectionFaces); // Verticles count
     }
 
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
     glDepthMask(GL_FALSE);
 
+    // Plants are single sided quads seen from both sides
+    glDisable(GL_CULL_FACE);
+
     floraShader->use();
     floraShader->setMat4("view", world->player->getViewMatrix());
     floraShader->setMat4("projection", projection);
     floraShader->setVec3("lightPos", this->lightPos);
     floraShader->setVec3("viewPos", world->player->getPosition());
+    floraShader->setFloat("dayLight", dayLight);
+    setLightSource(floraShader);
 
     // Draw all flora
     for (const auto &chunk: chunks) {
@@ -243,31 +342,21 @@ void ChunksRenderer::renderChunks(World *world, Shader *shader, Shader *waterSha
         if (distance > (runtimeConfig->maxRenderingDistance * CHUNK_SIZE_XZ)) {
             continue;
         }
-        BakedChunk *bakedChunk = chunk->getBakedChunk();
+        ChunkMesh *mesh = chunk->getMesh();
 
         // Chunk is not baked yet?
-        if (bakedChunk == nullptr) continue;;
+        if (mesh == nullptr) continue;
 
         pos.x = chunk->position.x * CHUNK_SIZE_XZ;
         pos.y = chunk->position.y * CHUNK_SIZE_Y;
         pos.z = chunk->position.z * CHUNK_SIZE_XZ;
 
-        // Draw not-solid
-        for (auto &part: bakedChunk->floraChunkParts) {
-            if (!part.hasBuffered()) {
-                part.bufferMesh();
-            }
-            glBindVertexArray(part.vao);
-
-            waterShader->setVec3("pos", pos);
-            waterShader->setVec3("worldPos", pos);
-
-            glBindTexture(GL_TEXTURE_2D, this->glTextures[part.blockID]);
-            glDrawElements(GL_TRIANGLES, part.indices.size(), GL_UNSIGNED_INT, nullptr);
-            lastCountOfTotalVertices += part.vertices.size() / 9; // Verticles count
-        }
+        floraShader->setVec3("pos", pos);
+        bindLightTexture(chunk);
+        lastCountOfTotalVertices += mesh->drawFlora(getFloraDensity(distance)); // Verticles count
     }
 
+    glEnable(GL_CULL_FACE);
     glDepthMask(GL_TRUE);
 
     // Render selected block
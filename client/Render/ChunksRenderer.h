@@ -8,6 +8,7 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <unordered_map>
+#include <algorithm>
 
 #include "../World/World.h"
 #include "../Shader.h"
@@ -33,7 +34,7 @@ class ChunksRenderer {
 
     RuntimeConfig *runtimeConfig;
 
-    std::unordered_map<BlockID, GLuint> glTextures;
+    GLuint blocksTextureArray; // Layer per block id
 
     GLuint vaoSelection;
     GLuint vboSelection;
@@ -45,12 +46,35 @@ class ChunksRenderer {
 
     bool isChunkInFrustum(const std::array<Plane, 6> &frustumPlanes, const glm::vec3 &chunkMin, const glm::vec3 &chunkMax);
 
+    // Bits of face directions that can face the camera somewhere in each section
+    void getSectionVisibleFaces(const glm::vec3 &cameraPos, const glm::vec3 &chunkPos, int sectionFaces[CHUNK_SECTIONS]);
+
+    // Part of plants drawn at this distance, fades out towards render distance
+    [[nodiscard]] float getFloraDensity(double distance) const;
+
+    // Brightness of sky light by the time of day, meshes keep light levels and don't change
+    [[nodiscard]] float getDayLight() const;
+
+    // Uploads pending chunk meshes, nearest first, until the per-frame budget is spent
+    void uploadPendingMeshes(const std::vector<Chunk *> &chunks, Vec3i playerChunkPos);
+
+    // Uploads changed light of baked chunks, light textures don't wait for the budget. Returns uploaded bytes
+    size_t uploadLightTextures(const std::vector<Chunk *> &chunks, World *world);
+
+    // Points a chunk shader at light textures or vertex light, by the runtime config
+    void setLightSource(Shader *shader) const;
+
+    // Binds the light texture of a chunk, if shaders read light from it
+    void bindLightTexture(const Chunk *chunk) const;
+
 public:
     Vec3i targetBlock = Vec3i(0, 0, 0);
 
     int lastCountOfTotalVertices = 0;
+    int lastCountOfPendingUploads = 0;
+    size_t lastCountOfUploadedBytes = 0;
 
-    ChunksRenderer(std::unordered_map<BlockID, GLuint> glTextures, RuntimeConfig *runtimeConfig);
+    ChunksRenderer(GLuint blocksTextureArray, RuntimeConfig *runtimeConfig);
 
     void renderChunks(World* world, Shader *shader, Shader *waterShader, Shader *selectionShader, Shader *floraShader, Vec3i playerPos);
 };
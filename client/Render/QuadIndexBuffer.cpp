@@ -0,0 +1,22 @@
+#include "QuadIndexBuffer.h"
+
+#include <vector>
+
+GLuint QuadIndexBuffer::getBuffer() {
+    static GLuint ebo = 0;
+    if (ebo != 0) return ebo;
+
+    std::vector<GLushort> indices;
+    indices.reserve(QUAD_INDEX_BUFFER_QUADS * 6);
+    for (GLuint quad = 0; quad < QUAD_INDEX_BUFFER_QUADS; ++quad) {
+        for (GLuint index: {0, 1, 2, 2, 3, 0}) {
+            indices.push_back(quad * 4 + index);
+        }
+    }
+
+    glGenBuffers(1, &ebo);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLushort), indices.data(), GL_STATIC_DRAW);
+
+    return ebo;
+}
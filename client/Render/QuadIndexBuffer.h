@@ -0,0 +1,18 @@
+#ifndef QUADINDEXBUFFER_H
+#define QUADINDEXBUFFER_H
+
+#include "../GL/glad.h"
+
+// 16-bit indices address 65536 vertices, 4 per quad
+#define QUAD_INDEX_BUFFER_QUADS 16384
+
+/**
+ * Shared element buffer with the 0-1-2-2-3-0 pattern of consecutive quads, referenced by every chunk VAO
+ */
+class QuadIndexBuffer {
+public:
+    // Creates the buffer on first use, GL thread only
+    static GLuint getBuffer();
+};
+
+#endif //QUADINDEXBUFFER_H
@@ -1 +1,77 @@
 #include "BakedChunk.h"
+
+#include <mutex>
+#include <utility>
+
+#include "ChunkVertexPool.h"
+
+#define MAX_FREE_BAKED_CHUNKS 256
+
+static std::mutex freeBakedChunksMutex;
+static std::vector<void *> freeBakedChunks;
+
+BakedChunk::~BakedChunk() {
+    releaseUploadSlot();
+
+    for (auto &sectionParts: parts) {
+        for (auto &part: sectionParts) {
+            ChunkVertexPool::shared().release(std::move(part.vertices));
+        }
+    }
+}
+
+void *BakedChunk::operator new(size_t size) {
+    {
+        std::lock_guard lock(freeBakedChunksMutex);
+        if (!freeBakedChunks.empty()) {
+            void *bakedChunk = freeBakedChunks.back();
+            freeBakedChunks.pop_back();
+            return bakedChunk;
+        }
+    }
+    return ::operator new(size);
+}
+
+void BakedChunk::operator delete(void *bakedChunk, size_t size) {
+    {
+        std::lock_guard lock(freeBakedChunksMutex);
+        if (freeBakedChunks.size() < MAX_FREE_BAKED_CHUNKS) {
+            freeBakedChunks.reserve(MAX_FREE_BAKED_CHUNKS);
+            freeBakedChunks.push_back(bakedChunk);
+            return;
+        }
+    }
+    ::operator delete(bakedChunk, size);
+}
+
+void BakedChunk::releaseUploadSlot() {
+    if (uploadSlot) {
+        uploadSlot->leave();
+        uploadSlot = nullptr;
+    }
+}
+
+bool BakedChunk::hasSection(int section) const {
+    return sectionMask & (1 << section);
+}
+
+void BakedChunk::mergeOlder(BakedChunk *older) {
+    for (int section = 0; section < CHUNK_SECTIONS; ++section) {
+        if (hasSection(section) || !older->hasSection(section)) continue;
+
+        for (int pass = 0; pass < CHUNK_PASS_COUNT; ++pass) {
+            parts[section][pass] = std::move(older->parts[section][pass]);
+        }
+        sectionMask |= 1 << section;
+    }
+}
+
+size_t BakedChunk::getMeshSizeBytes() const {
+    size_t size = 0;
+    for (const auto &sectionParts: parts) {
+        for (const auto &part: sectionParts) {
+            size += part.getMeshSizeBytes();
+        }
+    }
+    return size;
+}
@@ -4,19 +4,58 @@
 #include <SDL3/SDL_timer.h>
 #include <vector>
 #include "BakedChunkPart.h"
+#include "../constants.h"
+#include "../Jobs/BoundedStage.h"
+#include "../Math/Vec3i.h"
 
 #define CHUNK_BAKE_LIFETIME_MS 3500
 
+#define CHUNK_PASS_SOLID 0
+#define CHUNK_PASS_LIQUID 1
+#define CHUNK_PASS_FLORA 2
+#define CHUNK_PASS_COUNT 3
+
+// Quads in mesh passes, single plant vertices in the flora pass
+#define CHUNK_PASS_ELEMENT_VERTICES(pass) ((pass) == CHUNK_PASS_FLORA ? 1 : 4)
+
+/**
+ * Bake result for some sections of a chunk, applied to its ChunkMesh by the render thread
+ */
 class BakedChunk {
 public:
-    std::vector<BakedChunkPart> chunkParts;
-    std::vector<BakedChunkPart> liquidChunkParts;
-    std::vector<BakedChunkPart> floraChunkParts;
+    // Sections this bake covers, others keep their current mesh
+    uint8_t sectionMask = CHUNK_ALL_SECTIONS;
+    BakedChunkPart parts[CHUNK_SECTIONS][CHUNK_PASS_COUNT];
+
     long bakeTime = 0L;
+    float bakeDurationMs = 0.0f;
+    uint32_t version = 0; // Chunk version the bake started from
+
+    // Slot taken in the upload stage, freed once the mesh is on the GPU or dropped
+    BoundedStage *uploadSlot = nullptr;
+
+    // Hand-off from bakers to the render thread
+    Vec3i chunkPos = Vec3i(0, 0, 0);
+    BakedChunk *next = nullptr;
 
     BakedChunk() {
         bakeTime = SDL_GetTicks();
     }
+
+    ~BakedChunk();
+
+    // Bakes are made for every rebake, their memory is reused
+    static void *operator new(size_t size);
+    static void operator delete(void *bakedChunk, size_t size);
+
+    void releaseUploadSlot();
+
+    [[nodiscard]] bool hasSection(int section) const;
+
+    // Takes over sections of an older pending bake that this one doesn't cover
+    void mergeOlder(BakedChunk *older);
+
+    [[nodiscard]] size_t getMeshSizeBytes() const;
 };
 
 #endif //BAKEDCHUNK_H
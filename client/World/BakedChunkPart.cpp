@@ -1,35 +1,9 @@
 #include "BakedChunkPart.h"
 
-bool BakedChunkPart::hasBuffered() const {
-    return isBuffered;
+size_t BakedChunkPart::getElementCount() const {
+    return faceFirstElements[6];
 }
 
-void BakedChunkPart::bufferMesh() {
-    glGenVertexArrays(1, &vao);
-    glGenBuffers(1, &vbo);
-    glGenBuffers(1, &ebo);
-
-    glBindVertexArray(vao);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(GLfloat), vertices.data(),
-                 GL_STATIC_DRAW);
-
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), indices.data(),
-                 GL_STATIC_DRAW);
-
-    float stride = 9;
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride * sizeof(float), (void *) 0);
-    glEnableVertexAttribArray(0);
-
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride * sizeof(float), (void *) (3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride * sizeof(float), (void *) (6 * sizeof(float)));
-    glEnableVertexAttribArray(2);
-
-    glVertexAttribPointer(3, 1, GL_FLOAT, GL_FALSE, stride * sizeof(float), (void *) (8 * sizeof(float)));
-    glEnableVertexAttribArray(3);
-
-    isBuffered = true;
-}
\ No newline at end of file
+size_t BakedChunkPart::getMeshSizeBytes() const {
+    return vertices.size() * sizeof(ChunkVertex);
+}
@@ -1,25 +1,37 @@
 #ifndef BAKEDCHUNKPART_H
 #define BAKEDCHUNKPART_H
 
+#include <cstddef>
+#include <cstdint>
 #include <vector>
-#include "../GL/glad.h"
 
-#include "BlocksIds.h"
+// Packed chunk vertex, decoded in the chunk shaders
+// data:  x 5 bits | y 8 bits | z 5 bits | face 3 bits | corner 2 bits | ambient occlusion 2 bits
+// light: red, green, blue block light 6 bits each | sky light 6 bits | texture layer (block id) 8 bits.
+//        Light is in quarter levels, turned into brightness by the shaders
+struct ChunkVertex {
+    uint32_t data;
+    uint32_t light;
+};
+
+static_assert(sizeof(ChunkVertex) == 8, "Chunk vertex must stay 8 bytes");
 
+// Face 6 marks flora. A flora vertex is the whole plant, drawn as an instance of the cross mesh in flora.vert
+#define VERTEX_FACE_FLORA 6
+
+/**
+ * Geometry of one render pass of one chunk section, waiting for upload.
+ * Elements are quads of 4 vertices, indexed by QuadIndexBuffer, or plants of 1 vertex in the flora pass
+ */
 class BakedChunkPart {
 public:
-    std::vector<GLfloat> vertices;
-    std::vector<GLuint> indices;
-    BlockID blockID;
-
-    GLuint vao, vbo, ebo;
-    bool isBuffered; // TODO: Replace by checking VAO...
-    bool isSolid;
-    bool isFlora;
+    std::vector<ChunkVertex> vertices;
 
-    [[nodiscard]] bool hasBuffered() const;
+    // Elements are sorted by face direction, face i spans [faceFirstElements[i], faceFirstElements[i + 1])
+    uint32_t faceFirstElements[7] = {};
 
-    void bufferMesh();
+    [[nodiscard]] size_t getElementCount() const;
+    [[nodiscard]] size_t getMeshSizeBytes() const;
 };
 
 #endif //BAKEDCHUNKPART_H
@@ -8,6 +8,10 @@ bool Block::isFlora() const {
     return id == BLOCK_GRASS_BUSH || id == BLOCK_FLOWER_RED || id == BLOCK_TORCH;
 }
 
+bool Block::isOpaque() const {
+    return isSolid() && !isFlora();
+}
+
 
 BlockID Block::getId() const {
     return id;
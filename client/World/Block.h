@@ -16,6 +16,8 @@ public:
     void setBlockId(BlockID id);
     bool isSolid() const;
     bool isFlora() const;
+    // Blocks light and hides faces behind it
+    bool isOpaque() const;
 };
 
 #endif //BLOCK_H
@@ -1,8 +1,12 @@
 #ifndef BLOCKSIDS_H
 #define BLOCKSIDS_H
 
+#include <array>
+#include <cstdint>
 #include <string>
 
+#include "../constants.h"
+
 typedef int BlockID;
 
 enum BlocksIds: BlockID {
@@ -24,19 +28,22 @@ enum BlocksIds: BlockID {
     BLOCK_SNOW = 15,
 };
 
+#define BLOCK_ID_COUNT 16
+
 struct BlockData {
     std::string name;
     BlockID blockID;
     float atlasX, atlasY;
     bool isSolid;
     bool isFlora;
+    uint16_t lightEmission = 0; // Block light given off, colors packed as in Chunk::light
 };
 
 inline const BlockData BLOCKS_DATA[15] = {
     { "cobblestone", BLOCK_COBBLESTONE, 0, 32, true, false },
     { "dirt", BLOCK_DIRT, 0, 32, true, false },
     { "grass", BLOCK_GRASS, 32, 0, true, false },
-    { "lava", BLOCK_LAVA, 0, 64, false, false },
+    { "lava", BLOCK_LAVA, 0, 64, false, false, LIGHT_COLOR(15, 8, 3) },
     { "water", BLOCK_WATER, 64, 64, false, false },
     { "oak_leaves", BLOCK_LEAVES, 96, 0, true, false },
     { "oak_log", BLOCK_LOG, 64, 32, true, false },
@@ -46,8 +53,26 @@ inline const BlockData BLOCKS_DATA[15] = {
     { "iron_ore", BLOCK_IRON_ORE, 0, 0, true, false },
     { "grass_bush", BLOCK_GRASS_BUSH, 0, 0, false, true },
     { "flower_red", BLOCK_FLOWER_RED, 0, 0, false, true },
-    { "torch", BLOCK_TORCH, 0, 0, false, true },
+    { "torch", BLOCK_TORCH, 0, 0, false, true, LIGHT_COLOR(14, 12, 9) },
     { "snow", BLOCK_SNOW, 0, 0, true, false },
 };
 
+// Entries of BLOCKS_DATA by block id, air has none
+inline const std::array<const BlockData *, BLOCK_ID_COUNT> BLOCKS_DATA_BY_ID = [] {
+    std::array<const BlockData *, BLOCK_ID_COUNT> blocksData{};
+    for (const BlockData &data: BLOCKS_DATA) {
+        blocksData[data.blockID] = &data;
+    }
+    return blocksData;
+}();
+
+inline const BlockData *getBlockData(BlockID id) {
+    return id >= 0 && id < BLOCK_ID_COUNT ? BLOCKS_DATA_BY_ID[id] : nullptr;
+}
+
+inline uint16_t getBlockEmission(BlockID id) {
+    const BlockData *data = getBlockData(id);
+    return data ? data->lightEmission : 0;
+}
+
 #endif
\ No newline at end of file
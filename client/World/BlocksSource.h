@@ -3,6 +3,8 @@
 
 #include "Block.h"
 
+class Chunk;
+
 /**
  * Abstract source of blocks
  */
@@ -10,6 +12,9 @@ class BlocksSource {
 public:
     virtual Block *getBlock(Vec3i pos) = 0;
     virtual void setBlock(BlockID id, Vec3i pos) = 0;
+
+    // Direct chunk access for bulk reads, nullptr if not loaded
+    virtual Chunk *findChunkByChunkPos(Vec3i pos) = 0;
 };
 
 #endif
\ No newline at end of file
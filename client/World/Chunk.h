@@ -10,14 +10,35 @@
 #include "BlocksSource.h"
 #include "../constants.h"
 #include <array>
+#include <atomic>
+#include <bitset>
+#include <vector>
+
+class AbstractChunkMesher;
+class ChunkMesh;
+class ChunkLightTexture;
+
+// Block giving off light, chunk-local position
+struct LightEmitter {
+    uint8_t x;
+    uint8_t y;
+    uint8_t z;
+    uint16_t emission; // Colors packed as in Chunk::light
+};
 
 // TODO: Replace with real hash
 static int fakeHashIndex = 0;
 
 class Chunk {
 private:
-    BakedChunk *bakedChunk = nullptr;
-    BakedChunk *nextBakedChunk = nullptr;
+    // Render thread only
+    ChunkMesh *mesh = nullptr;
+    ChunkLightTexture *lightTexture = nullptr;
+    BakedChunk *pendingBakedChunk = nullptr;
+    uint32_t publishedVersion = 0;
+
+    // Adds, changes or drops the emitter at the position, no emission drops it
+    void updateEmitter(Vec3i pos, uint16_t emission);
 public:
     explicit Chunk(Vec3i position): position(position) {
         this->hash = fakeHashIndex++;
@@ -32,17 +53,8 @@ public:
         }
     }
 
-    ~Chunk() {
-        for (int x = 0; x < CHUNK_SIZE_XZ; ++x) {
-            for (int y = 0; y < CHUNK_SIZE_Y; ++y) {
-                for (int z = 0; z < CHUNK_SIZE_XZ; ++z) {
-                    Block *block = this->blocks[x][y][z];
-                    delete block;
-                }
-            }
-        }
-        delete this->bakedChunk;
-    }
+    // Frees GL objects of the mesh and the light texture, render thread only
+    ~Chunk();
 
     int hash = -1;
     Vec3i position;
@@ -50,49 +62,105 @@ public:
     std::array<std::array<std::array<Block*, CHUNK_SIZE_XZ>, CHUNK_SIZE_Y>, CHUNK_SIZE_XZ> blocks{};
 
     bool isNeedToUnload = false;
-    bool isNeedToRebake = false;
+
+    // Bumped by every edit that affects the mesh, a bake is stale if it changed meanwhile
+    std::atomic<uint32_t> version = 0;
+    // Version the latest bake started from
+    std::atomic<uint32_t> bakedVersion = 0;
+    // Sections edited since the latest bake started, the first bake takes all
+    std::atomic<uint8_t> dirtySections = CHUNK_ALL_SECTIONS;
+    // Sections with light changed since the latest upload of the light texture, padding included
+    std::atomic<uint8_t> lightTextureSections = CHUNK_ALL_SECTIONS;
+
+    // Light levels per block, red, green and blue block light in the low 12 bits, sky light in the high ones.
+    // Written by LightEngine only
+    std::array<uint16_t, CHUNK_VOLUME> light{};
+    // Lowest height open to the sky per column, nothing opaque at or above it
+    std::array<uint8_t, CHUNK_SIZE_XZ * CHUNK_SIZE_XZ> heightmap{};
+    // Border blocks with light that couldn't spread into a missing side neighbor yet, it spreads once the
+    // neighbor is generated. Per side (-z, +z, -x, +x), a bit per block along the border by height.
+    // Written by LightEngine only
+    std::array<std::bitset<CHUNK_SIZE_XZ * CHUNK_SIZE_Y>, 4> pendingLight;
+    // Blocks giving off light, kept by setBlock, so light passes don't scan the chunk for them
+    std::vector<LightEmitter> emitters;
+
+    static int getLightIndex(Vec3i pos) {
+        return (pos.x * CHUNK_SIZE_Y + pos.y) * CHUNK_SIZE_XZ + pos.z;
+    }
+
+    // Packed colors of block light or the sky level
+    [[nodiscard]] uint16_t getLight(Vec3i pos, int channel) const {
+        uint16_t value = light[getLightIndex(pos)];
+        return channel == LIGHT_CHANNEL_SKY ? value >> LIGHT_SKY_SHIFT : value & LIGHT_BLOCK_MASK;
+    }
+
+    void setLight(Vec3i pos, int channel, uint16_t level) {
+        uint16_t &value = light[getLightIndex(pos)];
+        if (channel == LIGHT_CHANNEL_SKY) value = (value & LIGHT_BLOCK_MASK) | level << LIGHT_SKY_SHIFT;
+        else value = (value & ~LIGHT_BLOCK_MASK) | level;
+    }
+
+    // All channels as stored
+    [[nodiscard]] uint16_t getLightLevels(Vec3i pos) const {
+        return light[getLightIndex(pos)];
+    }
+
+    [[nodiscard]] uint16_t getBlockLight(Vec3i pos) const {
+        return getLight(pos, LIGHT_CHANNEL_BLOCK);
+    }
+
+    [[nodiscard]] uint8_t getSkyLight(Vec3i pos) const {
+        return getLight(pos, LIGHT_CHANNEL_SKY);
+    }
+
+    [[nodiscard]] int getHeight(int x, int z) const {
+        return heightmap[x * CHUNK_SIZE_XZ + z];
+    }
+
+    // Rescans the column from the top
+    void updateHeight(int x, int z);
 
     void setBlock(BlockID id, Vec3i pos);
 
     [[nodiscard]] Block *getBlock(Vec3i pos) const;
     //std::pmr::unordered_map<int, BakedChunk *> cachedBakedChunks;
 
-    Vec3i neighborOffsets[6] = {
-        Vec3i(0, 0, -1), // front
-        Vec3i(0, 0, 1), // back
-        Vec3i(0, -1, 0), // bottom
-        Vec3i(0, 1, 0), // top
-        Vec3i(-1, 0, 0), // left
-        Vec3i(1, 0, 0), // right
-    };
-
-    glm::vec3 faceDirections[6] = {
-        glm::vec3(0, 0, -1), // front
-        glm::vec3(0, 0, 1), // back
-        glm::vec3(0, -1, 0), // bottom
-        glm::vec3(0, 1, 0), // top
-        glm::vec3(-1, 0, 0), // left
-        glm::vec3(1, 0, 0), // right
-    };
-
     [[nodiscard]] bool isBaked() const;
 
-    void addFace(std::vector<GLfloat> *vertices, std::vector<GLuint> *indices, Vec3i chunkPos, Block *currentBlock, glm::vec3 faceDirection, glm::vec3 offsets[], BlocksSource *blocksSource, Chunk *chunk);
+    // Builds meshes of dirty sections, caller hands them to the render thread via World::completedMeshes
+    BakedChunk *bakeChunk(BlocksSource *blocksSource, AbstractChunkMesher *mesher);
+    void requestRebake(uint8_t sections = CHUNK_ALL_SECTIONS);
 
-    void bakeChunk(BlocksSource *blocksSource);
-    void requestRebake();
+    // Mask of sections holding heights minY..maxY, clamped to the chunk
+    static uint8_t getSectionsInRange(int minY, int maxY);
+    [[nodiscard]] bool isNeedToRebake() const;
 
     [[nodiscard]] bool isBlockInBounds(Vec3i worldPos) const;
 
     Vec3i getBlockWorldPosition(Block *block) const;
 
-    BakedChunk *getBakedChunk() {
-        if (this->nextBakedChunk) {
-            delete this->bakedChunk;
-            this->bakedChunk = this->nextBakedChunk;
-            this->nextBakedChunk = nullptr;
-        }
-        return this->bakedChunk;
+    // Sections waiting for GPU upload, render thread only
+    [[nodiscard]] BakedChunk *getPendingBakedChunk() const {
+        return this->pendingBakedChunk;
+    }
+
+    // Render thread only, merges with a pending bake that wasn't uploaded yet
+    void setPendingBakedChunk(BakedChunk *bakedChunk);
+
+    // Uploads pending sections into the mesh, render thread only. Returns uploaded bytes
+    size_t applyPendingBakedChunk();
+
+    [[nodiscard]] ChunkMesh *getMesh() const {
+        return this->mesh;
+    }
+
+    void requestLightTextureUpload(uint8_t sections = CHUNK_ALL_SECTIONS);
+
+    // Uploads changed sections into the light texture, render thread only. Returns uploaded bytes
+    size_t applyLightTexture(BlocksSource *blocksSource);
+
+    [[nodiscard]] ChunkLightTexture *getLightTexture() const {
+        return this->lightTexture;
     }
 };
 
@@ -0,0 +1,45 @@
+#include "ChunkVertexPool.h"
+
+#include <utility>
+
+ChunkVertexPool::ChunkVertexPool() {
+    freeBuffers.reserve(MAX_FREE_BUFFERS);
+}
+
+ChunkVertexPool &ChunkVertexPool::shared() {
+    static ChunkVertexPool pool;
+    return pool;
+}
+
+std::vector<ChunkVertex> ChunkVertexPool::acquire(size_t vertexCount) {
+    std::vector<ChunkVertex> buffer;
+    {
+        std::lock_guard lock(mutex);
+
+        // Newest buffer that is big enough, otherwise the newest one grows
+        for (size_t i = freeBuffers.size(); i > 0; --i) {
+            if (freeBuffers[i - 1].capacity() >= vertexCount) {
+                std::swap(freeBuffers[i - 1], freeBuffers.back());
+                break;
+            }
+        }
+
+        if (!freeBuffers.empty()) {
+            buffer = std::move(freeBuffers.back());
+            freeBuffers.pop_back();
+        }
+    }
+
+    buffer.reserve(vertexCount);
+    return buffer;
+}
+
+void ChunkVertexPool::release(std::vector<ChunkVertex> &&buffer) {
+    if (buffer.capacity() == 0) return;
+    buffer.clear();
+
+    std::lock_guard lock(mutex);
+    if (freeBuffers.size() < MAX_FREE_BUFFERS) {
+        freeBuffers.push_back(std::move(buffer));
+    }
+}
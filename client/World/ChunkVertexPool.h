@@ -0,0 +1,29 @@
+#ifndef CHUNKVERTEXPOOL_H
+#define CHUNKVERTEXPOOL_H
+
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+#include "BakedChunkPart.h"
+
+/**
+ * Vertex buffers of applied bakes, handed back to the bakers instead of being freed
+ */
+class ChunkVertexPool {
+    std::mutex mutex;
+    std::vector<std::vector<ChunkVertex>> freeBuffers;
+public:
+    static constexpr size_t MAX_FREE_BUFFERS = 512;
+
+    ChunkVertexPool();
+
+    static ChunkVertexPool &shared();
+
+    // Empty buffer, reserved for vertexCount vertices
+    std::vector<ChunkVertex> acquire(size_t vertexCount);
+
+    void release(std::vector<ChunkVertex> &&buffer);
+};
+
+#endif //CHUNKVERTEXPOOL_H
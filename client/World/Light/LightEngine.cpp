@@ -0,0 +1,665 @@
+#include "LightEngine.h"
+
+#include <algorithm>
+#include <bit>
+#include <bitset>
+#include <SDL3/SDL_timer.h>
+
+// Chunk with its 8 neighbors, positions are relative to the center chunk and span [-CHUNK_SIZE_XZ, 2 * CHUNK_SIZE_XZ)
+struct LightEngine::Region {
+    Chunk *chunks[3][3] = {};
+    uint8_t changedSections[3][3] = {};
+    uint8_t changedTextureSections[3][3] = {};
+
+    static int getChunkIndex(int pos) {
+        return (pos + CHUNK_SIZE_XZ) / CHUNK_SIZE_XZ;
+    }
+
+    static int getLocal(int pos) {
+        return (pos + CHUNK_SIZE_XZ) % CHUNK_SIZE_XZ;
+    }
+
+    static bool isInBounds(int x, int y, int z) {
+        return x >= -CHUNK_SIZE_XZ && x < 2 * CHUNK_SIZE_XZ && z >= -CHUNK_SIZE_XZ && z < 2 * CHUNK_SIZE_XZ &&
+               y >= 0 && y < CHUNK_SIZE_Y;
+    }
+
+    [[nodiscard]] Chunk *getChunk(int x, int z) const {
+        return chunks[getChunkIndex(x)][getChunkIndex(z)];
+    }
+
+    [[nodiscard]] uint16_t getLight(Chunk *chunk, int x, int y, int z, int channel) const {
+        return chunk->getLight(Vec3i(getLocal(x), y, getLocal(z)), channel);
+    }
+
+    [[nodiscard]] Block *getBlock(Chunk *chunk, int x, int y, int z) const {
+        return chunk->getBlock(Vec3i(getLocal(x), y, getLocal(z)));
+    }
+
+    [[nodiscard]] int getHeight(Chunk *chunk, int x, int z) const {
+        return chunk->getHeight(getLocal(x), getLocal(z));
+    }
+
+    // Faces read light of the block in front of them, so blocks around the changed one are rebaked.
+    // Light textures hold just the block, in textures of neighbors as padding
+    void markChanged(int x, int y, int z) {
+        uint8_t sections = Chunk::getSectionsInRange(y - 1, y + 1);
+        uint8_t textureSections = Chunk::getSectionsInRange(y, y);
+        int minX = getChunkIndex(std::max(x - 1, -CHUNK_SIZE_XZ));
+        int maxX = getChunkIndex(std::min(x + 1, 2 * CHUNK_SIZE_XZ - 1));
+        int minZ = getChunkIndex(std::max(z - 1, -CHUNK_SIZE_XZ));
+        int maxZ = getChunkIndex(std::min(z + 1, 2 * CHUNK_SIZE_XZ - 1));
+        for (int cx = minX; cx <= maxX; ++cx) {
+            for (int cz = minZ; cz <= maxZ; ++cz) {
+                changedSections[cx][cz] |= sections;
+                changedTextureSections[cx][cz] |= textureSections;
+            }
+        }
+    }
+};
+
+static constexpr int LIGHT_OFFSETS[6][3] = {
+    {0, 0, -1}, {0, 0, 1}, {0, -1, 0}, {0, 1, 0}, {-1, 0, 0}, {1, 0, 0}
+};
+
+// Side of Chunk::pendingLight for each of LIGHT_OFFSETS, light never leaves a chunk vertically
+static constexpr int LIGHT_OFFSET_SIDES[6] = {0, 1, -1, -1, 2, 3};
+
+// Chunk offsets of the sides of Chunk::pendingLight, the opposite side is side ^ 1
+static constexpr int SIDE_OFFSETS[4][2] = {
+    {0, -1}, {0, 1}, {-1, 0}, {1, 0}
+};
+
+// Bit of a border block in Chunk::pendingLight, chunk-local position
+static int getPendingIndex(int side, int x, int y, int z) {
+    return (side < 2 ? x : z) * CHUNK_SIZE_Y + y;
+}
+
+// Border column of a side neighbor next to the center chunk of a region
+static void getNeighborBorder(int side, int along, int &x, int &z) {
+    x = side < 2 ? along : (side == 2 ? -1 : CHUNK_SIZE_XZ);
+    z = side >= 2 ? along : (side == 0 ? -1 : CHUNK_SIZE_XZ);
+}
+
+static bool isOpaque(Block *block) {
+    return block != nullptr && block->isOpaque();
+}
+
+// Light of a channel is handled as packed nibbles, all colors of block light in one go. Sky light is a single nibble
+static constexpr uint32_t NIBBLE_LOW_BITS = 0x1111;
+static constexpr uint32_t NIBBLE_HIGH_BITS = 0x8888;
+
+// Nibbles with any light, all bits set
+static uint16_t getLitMask(uint16_t light) {
+    return ((light | light >> 1 | light >> 2 | light >> 3) & NIBBLE_LOW_BITS) * 0x0F;
+}
+
+// Each nibble one level lower, dark ones stay dark
+static uint16_t dimLight(uint16_t light) {
+    return light - ((light | light >> 1 | light >> 2 | light >> 3) & NIBBLE_LOW_BITS);
+}
+
+// Nibbles of a that are lower than the same nibbles of b, all bits set. Nibbles are subtracted
+// without borrowing from each other, the borrow out of a nibble tells it's lower
+static uint16_t getDarkerMask(uint16_t a, uint16_t b) {
+    uint32_t x = a;
+    uint32_t y = b;
+    uint32_t difference = ((x | NIBBLE_HIGH_BITS) - (y & ~NIBBLE_HIGH_BITS)) ^ ((x ^ ~y) & NIBBLE_HIGH_BITS);
+    uint32_t borrow = ((~x & y) | (~(x ^ y) & difference)) & NIBBLE_HIGH_BITS;
+    return (borrow >> 3) * 0x0F;
+}
+
+// Brighter nibbles of both
+static uint16_t maxLight(uint16_t a, uint16_t b) {
+    return a ^ ((a ^ b) & getDarkerMask(a, b));
+}
+
+LightEngine::LightEngine(BlocksSource *blocksSource) {
+    this->blocksSource = blocksSource;
+}
+
+void LightEngine::initSkyLight(Chunk *chunk) {
+    for (int x = 0; x < CHUNK_SIZE_XZ; ++x) {
+        for (int z = 0; z < CHUNK_SIZE_XZ; ++z) {
+            chunk->updateHeight(x, z);
+            for (int y = chunk->getHeight(x, z); y < CHUNK_SIZE_Y; ++y) {
+                chunk->setLight(Vec3i(x, y, z), LIGHT_CHANNEL_SKY, LIGHT_LEVEL_MAX);
+            }
+        }
+    }
+}
+
+void LightEngine::loadRegion(Region &region, Chunk *center) {
+    for (int dx = -1; dx <= 1; ++dx) {
+        for (int dz = -1; dz <= 1; ++dz) {
+            Chunk *chunk = dx == 0 && dz == 0 ? center : blocksSource->findChunkByChunkPos(center->position + Vec3i(dx, 0, dz));
+            region.chunks[dx + 1][dz + 1] = chunk;
+        }
+    }
+}
+
+void LightEngine::queueSkyColumn(const Region &region, int x, int z, int minY, int maxY) {
+    Chunk *chunk = region.getChunk(x, z);
+    int height = region.getHeight(chunk, x, z);
+
+    // Open blocks next to the column are lower than the highest neighbor
+    int neighborsHeight = height;
+    for (int side = 0; side < 4; ++side) {
+        const int *offset = LIGHT_OFFSETS[side < 2 ? side : side + 2];
+        int nx = x + offset[0];
+        int nz = z + offset[2];
+        if (!Region::isInBounds(nx, 0, nz)) continue;
+
+        if (Chunk *neighbor = region.getChunk(nx, nz)) {
+            neighborsHeight = std::max(neighborsHeight, region.getHeight(neighbor, nx, nz));
+        }
+    }
+
+    int fromY = std::max(height, minY);
+    int toY = std::min(neighborsHeight - 1, maxY);
+    for (int y = fromY; y <= toY; ++y) {
+        queue.push_back({static_cast<int16_t>(x), static_cast<int16_t>(y), static_cast<int16_t>(z)});
+    }
+}
+
+void LightEngine::setLight(Chunk *chunk, LightNode node, int channel, uint16_t level) {
+    Vec3i local = Vec3i(Region::getLocal(node.x), node.y, Region::getLocal(node.z));
+    changes.push_back({node, static_cast<uint32_t>(changes.size()), static_cast<uint8_t>(channel), chunk->getLight(local, channel)});
+    chunk->setLight(local, channel, level);
+}
+
+void LightEngine::queueNeighbors(const Region &region, LightNode node) {
+    for (const auto &offset: LIGHT_OFFSETS) {
+        int x = node.x + offset[0];
+        int y = node.y + offset[1];
+        int z = node.z + offset[2];
+        if (!Region::isInBounds(x, y, z) || region.getChunk(x, z) == nullptr) continue;
+
+        queue.push_back({static_cast<int16_t>(x), static_cast<int16_t>(y), static_cast<int16_t>(z)});
+    }
+}
+
+void LightEngine::queueRemoval(const Region &region, LightNode node, int channel) {
+    Chunk *chunk = region.getChunk(node.x, node.z);
+    uint16_t level = region.getLight(chunk, node.x, node.y, node.z, channel);
+    if (level == 0) return;
+
+    setLight(chunk, node, channel, 0);
+    removalQueue.push_back({node, level});
+}
+
+void LightEngine::removeLight(Region &region, int channel) {
+    for (size_t i = 0; i < removalQueue.size(); ++i) {
+        LightRemoval removal = removalQueue[i];
+
+        for (const auto &offset: LIGHT_OFFSETS) {
+            int x = removal.node.x + offset[0];
+            int y = removal.node.y + offset[1];
+            int z = removal.node.z + offset[2];
+            if (!Region::isInBounds(x, y, z)) continue;
+
+            Chunk *chunk = region.getChunk(x, z);
+            if (chunk == nullptr) continue;
+
+            uint16_t level = region.getLight(chunk, x, y, z, channel);
+            if (level == 0) continue;
+
+            LightNode neighbor = {static_cast<int16_t>(x), static_cast<int16_t>(y), static_cast<int16_t>(z)};
+            uint16_t darker = level & getDarkerMask(level, removal.level);
+            if (level & ~darker & getLitMask(removal.level)) {
+                // Lit from elsewhere, fills the cleared area back
+                queue.push_back(neighbor);
+            }
+            if (darker == 0) continue;
+
+            uint16_t rest = level & ~darker;
+            setLight(chunk, neighbor, channel, rest);
+            removalQueue.push_back({neighbor, darker});
+
+            // Emitters keep shining
+            if (channel == LIGHT_CHANNEL_BLOCK) {
+                Block *block = region.getBlock(chunk, x, y, z);
+                uint16_t lit = maxLight(rest, block ? getBlockEmission(block->getId()) : 0);
+                if (lit != rest) {
+                    setLight(chunk, neighbor, channel, lit);
+                    queue.push_back(neighbor);
+                }
+            }
+        }
+    }
+    removalQueue.clear();
+}
+
+void LightEngine::floodLight(Region &region, int channel) {
+    for (size_t i = 0; i < queue.size(); ++i) {
+        LightNode node = queue[i];
+        Chunk *source = region.getChunk(node.x, node.z);
+        uint16_t level = dimLight(region.getLight(source, node.x, node.y, node.z, channel));
+        if (level == 0) continue;
+
+        for (int i = 0; i < 6; ++i) {
+            int x = node.x + LIGHT_OFFSETS[i][0];
+            int y = node.y + LIGHT_OFFSETS[i][1];
+            int z = node.z + LIGHT_OFFSETS[i][2];
+            if (!Region::isInBounds(x, y, z)) continue;
+
+            Chunk *chunk = region.getChunk(x, z);
+            if (chunk == nullptr) {
+                int side = LIGHT_OFFSET_SIDES[i];
+                source->pendingLight[side].set(getPendingIndex(side, Region::getLocal(node.x), node.y, Region::getLocal(node.z)));
+                continue;
+            }
+
+            uint16_t current = region.getLight(chunk, x, y, z, channel);
+            uint16_t lit = maxLight(current, level);
+            if (lit == current || isOpaque(region.getBlock(chunk, x, y, z))) continue;
+
+            LightNode neighbor = {static_cast<int16_t>(x), static_cast<int16_t>(y), static_cast<int16_t>(z)};
+            setLight(chunk, neighbor, channel, lit);
+            queue.push_back(neighbor);
+        }
+    }
+    queue.clear();
+}
+
+void LightEngine::commitChanges(Region &region) {
+    auto getKey = [](const LightChange &change) {
+        uint32_t x = change.node.x + CHUNK_SIZE_XZ;
+        uint32_t z = change.node.z + CHUNK_SIZE_XZ;
+        return ((x * CHUNK_SIZE_Y + change.node.y) * 3 * CHUNK_SIZE_XZ + z) * 2 + change.channel;
+    };
+
+    std::sort(changes.begin(), changes.end(), [&](const LightChange &a, const LightChange &b) {
+        uint32_t keyA = getKey(a);
+        uint32_t keyB = getKey(b);
+        return keyA != keyB ? keyA < keyB : a.order < b.order;
+    });
+
+    for (size_t i = 0; i < changes.size(); ++i) {
+        // The first write of a block holds its level before the pass
+        if (i > 0 && getKey(changes[i]) == getKey(changes[i - 1])) continue;
+
+        const LightNode &node = changes[i].node;
+        Chunk *chunk = region.getChunk(node.x, node.z);
+        if (region.getLight(chunk, node.x, node.y, node.z, changes[i].channel) != changes[i].level) {
+            region.markChanged(node.x, node.y, node.z);
+        }
+    }
+    changes.clear();
+}
+
+void LightEngine::markBorderTextures(Region &region) {
+    Chunk *center = region.chunks[1][1];
+    for (int cx = 0; cx < 3; ++cx) {
+        for (int cz = 0; cz < 3; ++cz) {
+            if ((cx == 1 && cz == 1) || region.chunks[cx][cz] == nullptr) continue;
+
+            // Columns of the center within a block of the neighbor
+            int minX = cx == 2 ? CHUNK_SIZE_XZ - 1 : 0;
+            int maxX = cx == 0 ? 0 : CHUNK_SIZE_XZ - 1;
+            int minZ = cz == 2 ? CHUNK_SIZE_XZ - 1 : 0;
+            int maxZ = cz == 0 ? 0 : CHUNK_SIZE_XZ - 1;
+            for (int x = minX; x <= maxX; ++x) {
+                for (int z = minZ; z <= maxZ; ++z) {
+                    for (int y = 0; y < CHUNK_SIZE_Y; ++y) {
+                        if (center->getLightLevels(Vec3i(x, y, z)) != 0) {
+                            region.changedTextureSections[cx][cz] |= Chunk::getSectionsInRange(y, y);
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+void LightEngine::requestRebakes(const Region &region, bool isCenterIncluded) const {
+    for (int cx = 0; cx < 3; ++cx) {
+        for (int cz = 0; cz < 3; ++cz) {
+            Chunk *chunk = region.chunks[cx][cz];
+            if (chunk == nullptr) continue;
+
+            if (region.changedTextureSections[cx][cz] != 0) {
+                chunk->requestLightTextureUpload(region.changedTextureSections[cx][cz]);
+            }
+
+            // Light textures take the changes without touching meshes
+            if (cx == 1 && cz == 1 && !isCenterIncluded) continue;
+            if (isVertexLightEnabled && region.changedSections[cx][cz] != 0) {
+                chunk->requestRebake(region.changedSections[cx][cz]);
+            }
+        }
+    }
+}
+
+void LightEngine::queueNeighborBorders(Region &region) {
+    for (int side = 0; side < 4; ++side) {
+        Chunk *neighbor = region.chunks[SIDE_OFFSETS[side][0] + 1][SIDE_OFFSETS[side][1] + 1];
+        if (neighbor == nullptr) continue;
+
+        // Side of the neighbor towards the center chunk
+        std::bitset<CHUNK_SIZE_XZ * CHUNK_SIZE_Y> &pending = neighbor->pendingLight[side ^ 1];
+        if (pending.none()) continue;
+
+        for (int along = 0; along < CHUNK_SIZE_XZ; ++along) {
+            int x, z;
+            getNeighborBorder(side, along, x, z);
+            for (int y = 0; y < CHUNK_SIZE_Y; ++y) {
+                if (!pending.test(getPendingIndex(side ^ 1, Region::getLocal(x), y, Region::getLocal(z)))) continue;
+
+                borderQueue.push_back({static_cast<int16_t>(x), static_cast<int16_t>(y), static_cast<int16_t>(z)});
+            }
+        }
+        pending.reset();
+    }
+}
+
+void LightEngine::lightChunk(Chunk *chunk) {
+    std::lock_guard lock(mutex);
+
+    Region region;
+    loadRegion(region, chunk);
+
+    // Light that waited at borders of neighbors, both channels spread from the same blocks
+    queueNeighborBorders(region);
+
+    // Own emitters
+    for (const LightEmitter &emitter: chunk->emitters) {
+        Vec3i pos = Vec3i(emitter.x, emitter.y, emitter.z);
+        uint16_t current = chunk->getBlockLight(pos);
+        uint16_t lit = maxLight(current, emitter.emission);
+        if (lit == current) continue;
+
+        LightNode node = {static_cast<int16_t>(emitter.x), static_cast<int16_t>(emitter.y), static_cast<int16_t>(emitter.z)};
+        setLight(chunk, node, LIGHT_CHANNEL_BLOCK, lit);
+        queue.push_back(node);
+    }
+    queue.insert(queue.end(), borderQueue.begin(), borderQueue.end());
+    floodLight(region, LIGHT_CHANNEL_BLOCK);
+
+    // Own open columns are lit already, they spread under overhangs here and next door.
+    // Open columns at borders of neighbors get under overhangs of this chunk
+    for (int x = 0; x < CHUNK_SIZE_XZ; ++x) {
+        for (int z = 0; z < CHUNK_SIZE_XZ; ++z) {
+            queueSkyColumn(region, x, z, 0, CHUNK_SIZE_Y - 1);
+        }
+    }
+    for (int side = 0; side < 4; ++side) {
+        if (region.chunks[SIDE_OFFSETS[side][0] + 1][SIDE_OFFSETS[side][1] + 1] == nullptr) continue;
+
+        for (int along = 0; along < CHUNK_SIZE_XZ; ++along) {
+            int x, z;
+            getNeighborBorder(side, along, x, z);
+            queueSkyColumn(region, x, z, 0, CHUNK_SIZE_Y - 1);
+        }
+    }
+    queue.insert(queue.end(), borderQueue.begin(), borderQueue.end());
+    floodLight(region, LIGHT_CHANNEL_SKY);
+    borderQueue.clear();
+
+    // The chunk itself is baked after this pass. Padding of light textures around takes in its lit border,
+    // open columns lit before the pass included
+    commitChanges(region);
+    markBorderTextures(region);
+    region.changedTextureSections[1][1] = CHUNK_ALL_SECTIONS;
+    requestRebakes(region, false);
+}
+
+void LightEngine::relightBlock(Chunk *chunk, Vec3i pos, bool wasOpaque, uint16_t oldEmission) {
+    relightBlocks(chunk, {{pos, wasOpaque, oldEmission}});
+}
+
+void LightEngine::relightBlocks(Chunk *chunk, const std::vector<LightEdit> &edits) {
+    if (edits.empty()) return;
+
+    std::lock_guard lock(mutex);
+
+    Region region;
+    loadRegion(region, chunk);
+
+    // Columns take their new heights first, both ways start from them. Sky light changes between
+    // the old and the new height, so sections relit from scratch have to reach there too
+    std::bitset<CHUNK_SIZE_XZ * CHUNK_SIZE_XZ> isColumnUpdated;
+    int minY = CHUNK_SIZE_Y - 1;
+    int maxY = 0;
+    for (const LightEdit &edit: edits) {
+        minY = std::min(minY, edit.pos.y);
+        maxY = std::max(maxY, edit.pos.y);
+
+        int column = edit.pos.x * CHUNK_SIZE_XZ + edit.pos.z;
+        if (isColumnUpdated.test(column)) continue;
+        isColumnUpdated.set(column);
+
+        int oldHeight = chunk->getHeight(edit.pos.x, edit.pos.z);
+        chunk->updateHeight(edit.pos.x, edit.pos.z);
+        int newHeight = chunk->getHeight(edit.pos.x, edit.pos.z);
+        if (oldHeight == newHeight) continue;
+
+        heightChanges.push_back({
+            static_cast<int16_t>(edit.pos.x), static_cast<int16_t>(edit.pos.z),
+            static_cast<int16_t>(oldHeight), static_cast<int16_t>(newHeight)
+        });
+        minY = std::min(minY, std::min(oldHeight, newHeight));
+        maxY = std::max(maxY, std::max(oldHeight, newHeight) - 1);
+    }
+
+    // A merged pass costs about the same per edit, a pass from scratch per section, whatever the edits are.
+    // A single edit is always merged, it tells nothing about batches
+    uint8_t sections = Chunk::getSectionsInRange(minY, maxY);
+    bool isBatch = edits.size() > 1;
+    bool isMerged = !isBatch || edits.size() * editRelightNs <= std::popcount(sections) * sectionRelightNs;
+
+    Uint64 startNs = SDL_GetTicksNS();
+    if (isMerged) {
+        relightEdits(region, chunk, edits);
+    } else {
+        relightSections(region, chunk, std::countr_zero(sections) * CHUNK_SECTION_SIZE,
+                        (std::bit_width(sections) * CHUNK_SECTION_SIZE) - 1);
+    }
+    heightChanges.clear();
+    commitChanges(region);
+
+    if (isBatch) {
+        float durationNs = static_cast<float>(SDL_GetTicksNS() - startNs);
+        if (isMerged) {
+            editRelightNs = editRelightNs * 0.9f + durationNs / static_cast<float>(edits.size()) * 0.1f;
+        } else {
+            sectionRelightNs = sectionRelightNs * 0.9f + durationNs / static_cast<float>(std::popcount(sections)) * 0.1f;
+        }
+    }
+
+    requestRebakes(region, true);
+}
+
+void LightEngine::relightEdits(Region &region, Chunk *chunk, const std::vector<LightEdit> &edits) {
+    // Block light, any color that got dimmer is removed with the rest
+    for (const LightEdit &edit: edits) {
+        Block *block = chunk->getBlock(edit.pos);
+        uint16_t emission = block ? getBlockEmission(block->getId()) : 0;
+        if (isOpaque(block) || maxLight(emission, edit.oldEmission) != emission) {
+            LightNode node = {static_cast<int16_t>(edit.pos.x), static_cast<int16_t>(edit.pos.y), static_cast<int16_t>(edit.pos.z)};
+            queueRemoval(region, node, LIGHT_CHANNEL_BLOCK);
+        }
+    }
+    removeLight(region, LIGHT_CHANNEL_BLOCK);
+
+    for (const LightEdit &edit: edits) {
+        LightNode node = {static_cast<int16_t>(edit.pos.x), static_cast<int16_t>(edit.pos.y), static_cast<int16_t>(edit.pos.z)};
+        Block *block = chunk->getBlock(edit.pos);
+        if (!isOpaque(block) && edit.wasOpaque) queueNeighbors(region, node);
+
+        uint16_t current = chunk->getBlockLight(edit.pos);
+        uint16_t lit = maxLight(current, block ? getBlockEmission(block->getId()) : 0);
+        if (lit != current) {
+            setLight(chunk, node, LIGHT_CHANNEL_BLOCK, lit);
+            queue.push_back(node);
+        }
+    }
+    floodLight(region, LIGHT_CHANNEL_BLOCK);
+
+    // Sky light, full levels of columns change between their old and new heights
+    for (const HeightChange &column: heightChanges) {
+        for (int y = column.oldHeight; y < column.newHeight; ++y) {
+            queueRemoval(region, {column.x, static_cast<int16_t>(y), column.z}, LIGHT_CHANNEL_SKY);
+        }
+    }
+    for (const LightEdit &edit: edits) {
+        if (!isOpaque(chunk->getBlock(edit.pos))) continue;
+
+        LightNode node = {static_cast<int16_t>(edit.pos.x), static_cast<int16_t>(edit.pos.y), static_cast<int16_t>(edit.pos.z)};
+        queueRemoval(region, node, LIGHT_CHANNEL_SKY);
+    }
+    removeLight(region, LIGHT_CHANNEL_SKY);
+
+    for (const HeightChange &column: heightChanges) {
+        for (int y = column.newHeight; y < column.oldHeight; ++y) {
+            LightNode columnNode = {column.x, static_cast<int16_t>(y), column.z};
+            setLight(chunk, columnNode, LIGHT_CHANNEL_SKY, LIGHT_LEVEL_MAX);
+            queue.push_back(columnNode);
+        }
+    }
+    for (const LightEdit &edit: edits) {
+        if (isOpaque(chunk->getBlock(edit.pos)) || !edit.wasOpaque) continue;
+
+        LightNode node = {static_cast<int16_t>(edit.pos.x), static_cast<int16_t>(edit.pos.y), static_cast<int16_t>(edit.pos.z)};
+        queueNeighbors(region, node);
+    }
+    floodLight(region, LIGHT_CHANNEL_SKY);
+}
+
+void LightEngine::relightSections(Region &region, Chunk *chunk, int minY, int maxY) {
+    int height = maxY - minY + 1;
+
+    // Levels before, blocks that end up with others are marked changed when the pass is done
+    boxLight.resize(CHUNK_SIZE_XZ * height * CHUNK_SIZE_XZ);
+    for (int x = 0; x < CHUNK_SIZE_XZ; ++x) {
+        for (int y = minY; y <= maxY; ++y) {
+            for (int z = 0; z < CHUNK_SIZE_XZ; ++z) {
+                boxLight[(x * height + y - minY) * CHUNK_SIZE_XZ + z] = chunk->getLightLevels(Vec3i(x, y, z));
+            }
+        }
+    }
+
+    for (int channel: {LIGHT_CHANNEL_BLOCK, LIGHT_CHANNEL_SKY}) {
+        // Light is cleared without tracking, light that left through the border is removed around as usual
+        for (int x = 0; x < CHUNK_SIZE_XZ; ++x) {
+            for (int y = minY; y <= maxY; ++y) {
+                for (int z = 0; z < CHUNK_SIZE_XZ; ++z) {
+                    uint16_t level = chunk->getLight(Vec3i(x, y, z), channel);
+                    if (level == 0) continue;
+
+                    chunk->setLight(Vec3i(x, y, z), channel, 0);
+                    bool isBorder = x == 0 || x == CHUNK_SIZE_XZ - 1 || z == 0 || z == CHUNK_SIZE_XZ - 1 || y == minY || y == maxY;
+                    if (isBorder) {
+                        removalQueue.push_back({{static_cast<int16_t>(x), static_cast<int16_t>(y), static_cast<int16_t>(z)}, level});
+                    }
+                }
+            }
+        }
+        removeLight(region, channel);
+        queueBoxBorder(region, minY, maxY, channel);
+
+        if (channel == LIGHT_CHANNEL_SKY) {
+            for (int x = 0; x < CHUNK_SIZE_XZ; ++x) {
+                for (int z = 0; z < CHUNK_SIZE_XZ; ++z) {
+                    for (int y = std::max(chunk->getHeight(x, z), minY); y <= maxY; ++y) {
+                        chunk->setLight(Vec3i(x, y, z), LIGHT_CHANNEL_SKY, LIGHT_LEVEL_MAX);
+                    }
+                    queueSkyColumn(region, x, z, minY, maxY);
+                }
+            }
+        } else {
+            for (const LightEmitter &emitter: chunk->emitters) {
+                if (emitter.y < minY || emitter.y > maxY) continue;
+
+                chunk->setLight(Vec3i(emitter.x, emitter.y, emitter.z), LIGHT_CHANNEL_BLOCK, emitter.emission);
+                queue.push_back({static_cast<int16_t>(emitter.x), static_cast<int16_t>(emitter.y), static_cast<int16_t>(emitter.z)});
+            }
+        }
+        floodLight(region, channel);
+    }
+
+    // Writes inside the box were tracked from cleared levels, levels before are compared here instead
+    std::erase_if(changes, [&](const LightChange &change) {
+        const LightNode &node = change.node;
+        return node.x >= 0 && node.x < CHUNK_SIZE_XZ && node.z >= 0 && node.z < CHUNK_SIZE_XZ &&
+               node.y >= minY && node.y <= maxY;
+    });
+    for (int x = 0; x < CHUNK_SIZE_XZ; ++x) {
+        for (int y = minY; y <= maxY; ++y) {
+            for (int z = 0; z < CHUNK_SIZE_XZ; ++z) {
+                if (boxLight[(x * height + y - minY) * CHUNK_SIZE_XZ + z] != chunk->getLightLevels(Vec3i(x, y, z))) {
+                    region.markChanged(x, y, z);
+                }
+            }
+        }
+    }
+}
+
+void LightEngine::queueBoxBorder(const Region &region, int minY, int maxY, int channel) {
+    auto queueIfLit = [&](int x, int y, int z) {
+        if (!Region::isInBounds(x, y, z)) return;
+
+        Chunk *chunk = region.getChunk(x, z);
+        if (chunk == nullptr || region.getLight(chunk, x, y, z, channel) == 0) return;
+
+        queue.push_back({static_cast<int16_t>(x), static_cast<int16_t>(y), static_cast<int16_t>(z)});
+    };
+
+    for (int a = 0; a < CHUNK_SIZE_XZ; ++a) {
+        for (int b = 0; b < CHUNK_SIZE_XZ; ++b) {
+            queueIfLit(a, minY - 1, b);
+            queueIfLit(a, maxY + 1, b);
+        }
+        for (int y = minY; y <= maxY; ++y) {
+            queueIfLit(-1, y, a);
+            queueIfLit(CHUNK_SIZE_XZ, y, a);
+            queueIfLit(a, y, -1);
+            queueIfLit(a, y, CHUNK_SIZE_XZ);
+        }
+    }
+}
+
+void LightEngine::removeChunkLight(Chunk *chunk) {
+    Region region;
+    loadRegion(region, chunk);
+    // Padding of light textures around goes dark where the chunk was lit
+    markBorderTextures(region);
+    // The chunk takes no part in the pass, light flowing back towards it stays pending at borders of neighbors
+    region.chunks[1][1] = nullptr;
+
+    for (int channel: {LIGHT_CHANNEL_BLOCK, LIGHT_CHANNEL_SKY}) {
+        // Border blocks of the chunk take their light away from neighbors, whatever is lit from elsewhere spreads again
+        for (int side = 0; side < 4; ++side) {
+            if (region.chunks[SIDE_OFFSETS[side][0] + 1][SIDE_OFFSETS[side][1] + 1] == nullptr) continue;
+
+            for (int along = 0; along < CHUNK_SIZE_XZ; ++along) {
+                // Own column next to the border column of the neighbor
+                int x, z;
+                getNeighborBorder(side, along, x, z);
+                x = std::clamp(x, 0, CHUNK_SIZE_XZ - 1);
+                z = std::clamp(z, 0, CHUNK_SIZE_XZ - 1);
+                for (int y = 0; y < CHUNK_SIZE_Y; ++y) {
+                    uint16_t level = chunk->getLight(Vec3i(x, y, z), channel);
+                    if (level == 0) continue;
+
+                    removalQueue.push_back({{static_cast<int16_t>(x), static_cast<int16_t>(y), static_cast<int16_t>(z)}, level});
+                }
+            }
+        }
+        removeLight(region, channel);
+        floodLight(region, channel);
+    }
+    commitChanges(region);
+    requestRebakes(region, false);
+
+    // Whole borders wait for the chunk, blocks without light to give are skipped by the flood
+    for (int side = 0; side < 4; ++side) {
+        if (Chunk *neighbor = region.chunks[SIDE_OFFSETS[side][0] + 1][SIDE_OFFSETS[side][1] + 1]) {
+            neighbor->pendingLight[side ^ 1].set();
+        }
+    }
+}
+
+void LightEngine::setVertexLightEnabled(bool isEnabled) {
+    isVertexLightEnabled = isEnabled;
+}
@@ -0,0 +1,154 @@
+#ifndef LIGHTENGINE_H
+#define LIGHTENGINE_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "../BlocksSource.h"
+#include "../Chunk.h"
+
+// Block changed inside a chunk, with what light needs to know about the block it replaced
+struct LightEdit {
+    Vec3i pos = Vec3i(0, 0, 0);
+    bool wasOpaque = false;
+    uint16_t oldEmission = 0;
+};
+
+/**
+ * Per-block light levels, spread by breadth-first flood fill. Block light comes from emitters,
+ * sky light from columns open to the sky, see Chunk::heightmap.
+ * Light fades by one level per block and stops at opaque blocks, so it never reaches
+ * further than the chunk next door. All passes work on a chunk with its 8 neighbors.
+ * Colors of block light spread together, every pass handles all channels of a block at once
+ */
+class LightEngine {
+    // Block position relative to the origin of the center chunk of a region
+    struct LightNode {
+        int16_t x;
+        int16_t y;
+        int16_t z;
+    };
+
+    // Block that lost light, neighbors with less light than it had lose theirs too. Per color for block light
+    struct LightRemoval {
+        LightNode node;
+        uint16_t level;
+    };
+
+    // Write of a light level, keeps the level it replaced
+    struct LightChange {
+        LightNode node;
+        uint32_t order;
+        uint8_t channel;
+        uint16_t level;
+    };
+
+    // Column whose highest opaque block moved, chunk-local
+    struct HeightChange {
+        int16_t x;
+        int16_t z;
+        int16_t oldHeight;
+        int16_t newHeight;
+    };
+
+    struct Region;
+
+    BlocksSource *blocksSource;
+
+    // Passes run one at a time, bakers read light without locking and are rebaked on changes
+    std::mutex mutex;
+
+    std::vector<LightNode> queue;
+    std::vector<LightRemoval> removalQueue;
+    std::vector<LightChange> changes;
+    std::vector<LightNode> borderQueue;
+    std::vector<HeightChange> heightChanges;
+    std::vector<uint16_t> boxLight;
+
+    // Measured time of relighting a batch, per edit merged into one pass and per section relit from scratch.
+    // A batch takes the cheaper way, sections win when most of their blocks are edited
+    float editRelightNs = 2000.0f;
+    float sectionRelightNs = 1000000.0f;
+
+    // Off when shaders read light from light textures, changes of light don't rebake meshes then
+    std::atomic<bool> isVertexLightEnabled = true;
+
+    void loadRegion(Region &region, Chunk *center);
+
+    void setLight(Chunk *chunk, LightNode node, int channel, uint16_t level);
+
+    // Queues full sky light of a column that can spread sideways, below the top of neighbor columns
+    void queueSkyColumn(const Region &region, int x, int z, int minY, int maxY);
+
+    // Queues lit neighbors of a block, their light flows into it
+    void queueNeighbors(const Region &region, LightNode node);
+
+    // Takes light of a block away, later removeLight() clears what it lit
+    void queueRemoval(const Region &region, LightNode node, int channel);
+
+    // Clears light spread from queued removals, lit blocks at the edge of the cleared area are queued to spread again
+    void removeLight(Region &region, int channel);
+
+    // Spreads light of queued blocks until it fades out. Light stopped by a missing chunk is kept pending
+    void floodLight(Region &region, int channel);
+
+    // Border blocks of side neighbors with light pending for the center chunk, and their open columns
+    void queueNeighborBorders(Region &region);
+
+    // Lit blocks around sections minY..maxY of the center chunk, their light flows into it
+    void queueBoxBorder(const Region &region, int minY, int maxY, int channel);
+
+    // Removes light around all edits and spreads it again in one pass per channel, only blocks with changed levels are touched
+    void relightEdits(Region &region, Chunk *chunk, const std::vector<LightEdit> &edits);
+
+    // Clears sections minY..maxY of the center chunk with light they spread around, then lights them again
+    // from emitters, open columns and blocks around
+    void relightSections(Region &region, Chunk *chunk, int minY, int maxY);
+
+    // Marks sections around blocks that ended up with another level than they had before the pass
+    void commitChanges(Region &region);
+
+    // Marks light texture sections of neighbors whose padding holds lit border blocks of the center chunk
+    static void markBorderTextures(Region &region);
+
+    // Clears light that came from the chunk out of its neighbors, their borders wait for it to come back
+    void removeChunkLight(Chunk *chunk);
+
+    // Rebakes changed sections and uploads them into light textures, the center is rebaked only if included.
+    // Light textures of the center are uploaded anyway
+    void requestRebakes(const Region &region, bool isCenterIncluded) const;
+public:
+    explicit LightEngine(BlocksSource *blocksSource);
+
+    // Heightmap and full sky light of open columns of a generated chunk, before other threads can see it
+    static void initSkyLight(Chunk *chunk);
+
+    // First light pass of a generated chunk: spreads its light into neighbors and light pending at their borders
+    // into it. Doesn't need all neighbors, missing ones get the light when they are generated.
+    // Sections of neighbors that changed are rebaked
+    void lightChunk(Chunk *chunk);
+
+    // Takes light the chunk spread into neighbors away, light of neighbors has to get into the chunk again
+    // when it is generated anew. removeChunk() hides the chunk from other passes before the lock is released
+    template <typename RemoveChunk>
+    void unloadChunk(Chunk *chunk, RemoveChunk &&removeChunk) {
+        std::lock_guard lock(mutex);
+        removeChunkLight(chunk);
+        removeChunk();
+    }
+
+    // Whether meshes bake light into vertices, so light changes rebake them
+    void setVertexLightEnabled(bool isEnabled);
+
+    // Updates light after a block inside the chunk changed its opacity or emission, only blocks with
+    // changed levels are touched. Sections that changed are rebaked
+    void relightBlock(Chunk *chunk, Vec3i pos, bool wasOpaque, uint16_t oldEmission);
+
+    // Updates light after many blocks inside the chunk changed at once, in one pass. Edits are merged or
+    // their sections relit from scratch, whichever took less time lately. Sections that changed are rebaked
+    void relightBlocks(Chunk *chunk, const std::vector<LightEdit> &edits);
+};
+
+#endif //LIGHTENGINE_H
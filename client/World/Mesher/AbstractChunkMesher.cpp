@@ -0,0 +1,60 @@
+#include "AbstractChunkMesher.h"
+
+bool AbstractChunkMesher::isFaceVisible(Block *currentBlock, Block *neighborBlock, int face) {
+    // Skip bottom face for bottom block
+    if (face == FACE_BOTTOM && currentBlock->getChunkPosition().y == 0) return false;
+
+    if (neighborBlock == nullptr || neighborBlock->getId() == BLOCK_AIR) return true;
+    return (!neighborBlock->isSolid() || neighborBlock->isFlora()) && currentBlock->isSolid();
+}
+
+Block *AbstractChunkMesher::getNeighborBlock(Chunk *chunk, BlocksSource *blocksSource, Vec3i chunkPos) {
+    if (chunkPos.x >= 0 && chunkPos.x < CHUNK_SIZE_XZ && chunkPos.z >= 0 && chunkPos.z < CHUNK_SIZE_XZ) {
+        return chunk->getBlock(chunkPos);
+    }
+
+    Vec3i worldPos = chunkPos + Vec3i(chunk->position.x * CHUNK_SIZE_XZ, 0, chunk->position.z * CHUNK_SIZE_XZ);
+    return blocksSource->getBlock(worldPos);
+}
+
+uint16_t AbstractChunkMesher::getFaceLight(Chunk *chunk, Block *currentBlock, int face, BlocksSource *blocksSource) {
+    const int *normal = NEIGHBOR_OFFSETS[face];
+    Vec3i frontPos = currentBlock->getChunkPosition() + Vec3i(normal[0], normal[1], normal[2]);
+    return getLightLevels(chunk, blocksSource, frontPos);
+}
+
+uint16_t AbstractChunkMesher::getLightLevels(Chunk *chunk, BlocksSource *blocksSource, Vec3i chunkPos) {
+    if (chunkPos.y >= CHUNK_SIZE_Y) return LIGHT_LEVEL_MAX << LIGHT_SKY_SHIFT;
+    if (chunkPos.y < 0) return 0;
+    if (chunkPos.x >= 0 && chunkPos.x < CHUNK_SIZE_XZ && chunkPos.z >= 0 && chunkPos.z < CHUNK_SIZE_XZ) {
+        return chunk->getLightLevels(chunkPos);
+    }
+
+    Vec3i neighborOffset = Vec3i(chunkPos.x < 0 ? -1 : chunkPos.x >= CHUNK_SIZE_XZ, 0, chunkPos.z < 0 ? -1 : chunkPos.z >= CHUNK_SIZE_XZ);
+    Chunk *neighbor = blocksSource->findChunkByChunkPos(chunk->position + neighborOffset);
+    if (neighbor == nullptr) return 0;
+
+    return neighbor->getLightLevels(chunkPos - neighborOffset * CHUNK_SIZE_XZ);
+}
+
+int AbstractChunkMesher::getFaceAO(Chunk *chunk, BlocksSource *blocksSource, int face, Vec3i pos) {
+    return getFaceAO(face, pos, [&](int x, int y, int z) {
+        if (y < 0 || y >= CHUNK_SIZE_Y) return false;
+
+        Block *block = getNeighborBlock(chunk, blocksSource, Vec3i(x, y, z));
+        return block != nullptr && block->isOpaque();
+    });
+}
+
+FaceLight AbstractChunkMesher::getSmoothFaceLight(Chunk *chunk, BlocksSource *blocksSource, int face, Vec3i pos) {
+    auto isOpaque = [&](int x, int y, int z) {
+        if (y < 0 || y >= CHUNK_SIZE_Y) return false;
+
+        Block *block = getNeighborBlock(chunk, blocksSource, Vec3i(x, y, z));
+        return block != nullptr && block->isOpaque();
+    };
+    auto getLevels = [&](Vec3i blockPos) {
+        return getLightLevels(chunk, blocksSource, blockPos);
+    };
+    return getSmoothFaceLight(face, pos, isOpaque, getLevels);
+}
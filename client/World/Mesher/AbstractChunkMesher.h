@@ -0,0 +1,160 @@
+#ifndef ABSTRACTCHUNKMESHER_H
+#define ABSTRACTCHUNKMESHER_H
+
+#include "../Chunk.h"
+#include "../BlocksSource.h"
+#include "ChunkMeshBuilder.h"
+
+/**
+ * Turns chunk blocks into geometry, selectable at runtime
+ */
+class AbstractChunkMesher {
+public:
+    virtual ~AbstractChunkMesher() = default;
+
+    [[nodiscard]] virtual const char *getName() const = 0;
+
+    virtual void bake(Chunk *chunk, BlocksSource *blocksSource, ChunkMeshBuilder &builder) = 0;
+
+    // Same order as FACE_* ids
+    static constexpr int NEIGHBOR_OFFSETS[6][3] = {
+        {0, 0, -1}, // front
+        {0, 0, 1}, // back
+        {0, -1, 0}, // bottom
+        {0, 1, 0}, // top
+        {-1, 0, 0}, // left
+        {1, 0, 0}, // right
+    };
+
+    // Normal, width (U) and height (V) axes of each face, 0 - x, 1 - y, 2 - z
+    static constexpr int FACE_AXES[6][3] = {
+        {2, 0, 1}, // front
+        {2, 0, 1}, // back
+        {1, 0, 2}, // bottom
+        {1, 0, 2}, // top
+        {0, 2, 1}, // left
+        {0, 2, 1}, // right
+    };
+
+    static constexpr int AXIS_SIZES[3] = {CHUNK_SIZE_XZ, CHUNK_SIZE_Y, CHUNK_SIZE_XZ};
+
+    // Merged quads interpolate AO between their own corners, so cells join along an axis only if AO is flat along it
+    static bool isAOFlatAlongU(int ao) {
+        return ((ao ^ (ao >> 2)) & 0b110011) == 0; // Corners 0 == 1, 2 == 3
+    }
+
+    static bool isAOFlatAlongV(int ao) {
+        return ((ao ^ (ao >> 6)) & 0b11) == 0 && ((ao ^ (ao >> 2)) & 0b1100) == 0; // Corners 0 == 3, 1 == 2
+    }
+
+    // Smooth light is interpolated the same way
+    static bool isLightFlatAlongU(const FaceLight &light) {
+        return light[0] == light[1] && light[3] == light[2];
+    }
+
+    static bool isLightFlatAlongV(const FaceLight &light) {
+        return light[0] == light[3] && light[1] == light[2];
+    }
+protected:
+    // Face is visible if nothing covers it, liquids only show faces towards air
+    static bool isFaceVisible(Block *currentBlock, Block *neighborBlock, int face);
+
+    // Looks inside the chunk first, world lookup is slow
+    static Block *getNeighborBlock(Chunk *chunk, BlocksSource *blocksSource, Vec3i chunkPos);
+
+    // Light levels of the block in front of the face, packed as in Chunk::light
+    static uint16_t getFaceLight(Chunk *chunk, Block *currentBlock, int face, BlocksSource *blocksSource);
+
+    // Light levels of a chunk block or a block of a neighbor chunk. Above the world is open sky, below is dark
+    static uint16_t getLightLevels(Chunk *chunk, BlocksSource *blocksSource, Vec3i chunkPos);
+
+    // Vertex light of stored light levels, every nibble widened to a channel of quarter levels
+    static uint32_t getVertexLight(uint16_t levels) {
+        uint32_t light = 0;
+        for (int channel = 0; channel < 4; ++channel) {
+            light |= (levels >> (channel * 4) & 0x0F) * 4u << (channel * VERTEX_LIGHT_CHANNEL_BITS);
+        }
+        return light;
+    }
+
+    // Same vertex light in every corner, liquids aren't smoothed
+    static FaceLight getFlatFaceLight(uint32_t light) {
+        return {light, light, light, light};
+    }
+
+    // Blocks in front of the face around each corner: the one in front, two along the face sides and the diagonal one
+    template <typename Callback>
+    static void forEachFaceCorner(int face, Vec3i pos, Callback &&callback) {
+        const int *normal = NEIGHBOR_OFFSETS[face];
+        int front[3] = {pos.x + normal[0], pos.y + normal[1], pos.z + normal[2]};
+        const int uAxis = FACE_AXES[face][1];
+        const int vAxis = FACE_AXES[face][2];
+        const int cornerSigns[4][2] = { {-1, -1}, {1, -1}, {1, 1}, {-1, 1} };
+
+        for (int corner = 0; corner < 4; ++corner) {
+            int side1[3] = {front[0], front[1], front[2]};
+            int side2[3] = {front[0], front[1], front[2]};
+            side1[uAxis] += cornerSigns[corner][0];
+            side2[vAxis] += cornerSigns[corner][1];
+            int diagonal[3] = {side1[0], side1[1], side1[2]};
+            diagonal[vAxis] += cornerSigns[corner][1];
+
+            callback(corner, front, side1, side2, diagonal);
+        }
+    }
+
+    // Classic side-side-corner occlusion of the face corners, from opaque blocks in front of the face
+    template <typename IsOpaque>
+    static int getFaceAO(int face, Vec3i pos, IsOpaque &&isOpaque) {
+        int ao = 0;
+        forEachFaceCorner(face, pos, [&](int corner, const int *front, const int *side1, const int *side2, const int *diagonal) {
+            bool isSide1 = isOpaque(side1[0], side1[1], side1[2]);
+            bool isSide2 = isOpaque(side2[0], side2[1], side2[2]);
+            bool isDiagonal = isOpaque(diagonal[0], diagonal[1], diagonal[2]);
+
+            int cornerAO = (isSide1 && isSide2) ? 0 : 3 - (isSide1 + isSide2 + isDiagonal);
+            ao |= cornerAO << (corner * 2);
+        });
+        return ao;
+    }
+
+    // Same occlusion with blocks taken from the chunk and its neighbors
+    static int getFaceAO(Chunk *chunk, BlocksSource *blocksSource, int face, Vec3i pos);
+
+    // Smooth light of the face corners, levels of the blocks around each corner in front of the face averaged.
+    // Opaque blocks are left out, and so is the diagonal one behind two opaque sides
+    template <typename IsOpaque, typename GetLightLevels>
+    static FaceLight getSmoothFaceLight(int face, Vec3i pos, IsOpaque &&isOpaque, GetLightLevels &&getLightLevels) {
+        FaceLight light;
+        forEachFaceCorner(face, pos, [&](int corner, const int *front, const int *side1, const int *side2, const int *diagonal) {
+            // Nibbles of up to 4 blocks summed at once, each in a byte of its own
+            uint32_t sums = 0;
+            int count = 0;
+            auto add = [&](const int *blockPos) {
+                uint32_t levels = getLightLevels(Vec3i(blockPos[0], blockPos[1], blockPos[2]));
+                sums += (levels & 0x000F) | (levels & 0x00F0) << 4 | (levels & 0x0F00) << 8 | (levels & 0xF000) << 12;
+                count++;
+            };
+
+            bool isSide1 = isOpaque(side1[0], side1[1], side1[2]);
+            bool isSide2 = isOpaque(side2[0], side2[1], side2[2]);
+            add(front);
+            if (!isSide1) add(side1);
+            if (!isSide2) add(side2);
+            if (!(isSide1 && isSide2) && !isOpaque(diagonal[0], diagonal[1], diagonal[2])) add(diagonal);
+
+            // Quarter levels, rounded
+            light[corner] = 0;
+            for (int channel = 0; channel < 4; ++channel) {
+                uint32_t sum = sums >> (channel * 8) & 0xFF;
+                light[corner] |= (sum * 4 + count / 2) / count << (channel * VERTEX_LIGHT_CHANNEL_BITS);
+            }
+        });
+        return light;
+    }
+
+    // Same light with blocks taken from the chunk and its neighbors
+    static FaceLight getSmoothFaceLight(Chunk *chunk, BlocksSource *blocksSource, int face, Vec3i pos);
+};
+
+#endif //ABSTRACTCHUNKMESHER_H
@@ -0,0 +1,284 @@
+#include "BinaryChunkMesher.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+
+static_assert(CHUNK_SIZE_Y == 128, "Column masks hold 128 blocks");
+static_assert(CHUNK_SIZE_XZ <= 16, "Bit plane rows hold 16 blocks");
+
+#define PADDED_SIZE_XZ (CHUNK_SIZE_XZ + 2)
+
+// Bit y is set if the block at height y matches
+struct ColumnMask {
+    uint64_t low = 0;  // y 0..63
+    uint64_t high = 0; // y 64..127
+
+    ColumnMask operator&(const ColumnMask &other) const { return {low & other.low, high & other.high}; }
+    ColumnMask operator|(const ColumnMask &other) const { return {low | other.low, high | other.high}; }
+    ColumnMask operator~() const { return {~low, ~high}; }
+
+    // Bit y holds the block above (y + 1), nothing above the top
+    [[nodiscard]] ColumnMask above() const { return {(low >> 1) | (high << 63), high >> 1}; }
+
+    // Bit y holds the block below (y - 1), nothing below the bottom
+    [[nodiscard]] ColumnMask below() const { return {low << 1, (high << 1) | (low >> 63)}; }
+
+    void set(int y) {
+        if (y < 64) low |= 1ull << y;
+        else high |= 1ull << (y - 64);
+    }
+
+    [[nodiscard]] bool test(int y) const {
+        if (y < 0 || y >= 128) return false;
+        return y < 64 ? (low >> y) & 1 : (high >> (y - 64)) & 1;
+    }
+
+    template <typename F>
+    void forEach(F &&callback) const {
+        for (uint64_t bits = low; bits; bits &= bits - 1) callback(std::countr_zero(bits));
+        for (uint64_t bits = high; bits; bits &= bits - 1) callback(64 + std::countr_zero(bits));
+    }
+};
+
+static const ColumnMask TOP_BIT = {0, 1ull << 63};
+static const ColumnMask BOTTOM_BIT = {1, 0};
+static const ColumnMask ALL_BITS = {~0ull, ~0ull};
+
+struct ChunkColumns {
+    // Padded by one column around the chunk, [x + 1][z + 1]
+    ColumnMask opaque[PADDED_SIZE_XZ][PADDED_SIZE_XZ];
+    ColumnMask liquid[PADDED_SIZE_XZ][PADDED_SIZE_XZ];
+    ColumnMask empty[PADDED_SIZE_XZ][PADDED_SIZE_XZ]; // Air or nothing, liquids only show faces towards it
+
+    void add(Block *block, int px, int y, int pz) {
+        if (block == nullptr || block->getId() == BLOCK_AIR) empty[px][pz].set(y);
+        else if (block->isFlora()) return;
+        else if (block->isSolid()) opaque[px][pz].set(y);
+        else liquid[px][pz].set(y);
+    }
+
+    void addColumn(Chunk *chunk, int x, int z, int px, int pz) {
+        // Missing neighbors count as nothing, like World::getBlock
+        if (chunk == nullptr) {
+            empty[px][pz] = ALL_BITS;
+            return;
+        }
+
+        for (int y = 0; y < CHUNK_SIZE_Y; ++y) {
+            add(chunk->getBlock(Vec3i(x, y, z)), px, y, pz);
+        }
+    }
+};
+
+struct FaceCell {
+    BlockID id;
+    FaceLight light;
+    int ao;
+
+    bool operator==(const FaceCell &other) const {
+        return id == other.id && light == other.light && ao == other.ao;
+    }
+};
+
+static int getBlockIndex(int x, int y, int z) {
+    return (x * CHUNK_SIZE_Y + y) * CHUNK_SIZE_XZ + z;
+}
+
+// Reused by bakes of the same thread, so steady state baking doesn't allocate
+struct BinaryMesherScratch {
+    ChunkColumns columns;
+    std::vector<BlockID> ids = std::vector<BlockID>(CHUNK_SIZE_XZ * CHUNK_SIZE_Y * CHUNK_SIZE_XZ);
+    std::vector<Vec3i> flora;
+
+    // Face planes, one row of U bits per V, for every slice along the normal
+    std::vector<uint16_t> planes = std::vector<uint16_t>(CHUNK_SIZE_XZ * CHUNK_SIZE_Y);
+
+    void clear() {
+        columns = ChunkColumns();
+        std::fill(ids.begin(), ids.end(), BLOCK_AIR);
+        flora.clear();
+    }
+};
+
+void BinaryChunkMesher::bake(Chunk *chunk, BlocksSource *blocksSource, ChunkMeshBuilder &builder) {
+    static thread_local BinaryMesherScratch scratch;
+    scratch.clear();
+
+    ChunkColumns &columns = scratch.columns;
+    std::vector<BlockID> &ids = scratch.ids;
+    std::vector<Vec3i> &flora = scratch.flora;
+    std::vector<uint16_t> &planes = scratch.planes;
+
+    for (int x = 0; x < CHUNK_SIZE_XZ; ++x) {
+        for (int z = 0; z < CHUNK_SIZE_XZ; ++z) {
+            for (int y = 0; y < CHUNK_SIZE_Y; ++y) {
+                Block *block = chunk->getBlock(Vec3i(x, y, z));
+                columns.add(block, x + 1, y, z + 1);
+                if (block == nullptr) continue;
+
+                ids[getBlockIndex(x, y, z)] = block->getId();
+                if (block->isFlora()) flora.push_back(Vec3i(x, y, z));
+            }
+        }
+    }
+
+    // Border columns of neighbors, sides for culling, corners for ambient occlusion
+    Chunk *neighbors[3][3];
+    for (int dx = -1; dx <= 1; ++dx) {
+        for (int dz = -1; dz <= 1; ++dz) {
+            neighbors[dx + 1][dz + 1] = dx == 0 && dz == 0 ? chunk : blocksSource->findChunkByChunkPos(chunk->position + Vec3i(dx, 0, dz));
+        }
+    }
+    for (int i = 0; i < CHUNK_SIZE_XZ; ++i) {
+        columns.addColumn(neighbors[0][1], CHUNK_SIZE_XZ - 1, i, 0, i + 1);
+        columns.addColumn(neighbors[2][1], 0, i, PADDED_SIZE_XZ - 1, i + 1);
+        columns.addColumn(neighbors[1][0], i, CHUNK_SIZE_XZ - 1, i + 1, 0);
+        columns.addColumn(neighbors[1][2], i, 0, i + 1, PADDED_SIZE_XZ - 1);
+    }
+    for (int dx = -1; dx <= 1; dx += 2) {
+        for (int dz = -1; dz <= 1; dz += 2) {
+            Chunk *corner = neighbors[dx + 1][dz + 1];
+            int x = dx < 0 ? CHUNK_SIZE_XZ - 1 : 0;
+            int z = dz < 0 ? CHUNK_SIZE_XZ - 1 : 0;
+            columns.addColumn(corner, x, z, dx < 0 ? 0 : PADDED_SIZE_XZ - 1, dz < 0 ? 0 : PADDED_SIZE_XZ - 1);
+        }
+    }
+
+    // Light around faces, neighbors hold it past the borders
+    auto getLightLevels = [&](Vec3i pos) -> uint16_t {
+        if (pos.y >= CHUNK_SIZE_Y) return LIGHT_LEVEL_MAX << LIGHT_SKY_SHIFT;
+        if (pos.y < 0) return 0;
+
+        int cx = pos.x < 0 ? 0 : (pos.x < CHUNK_SIZE_XZ ? 1 : 2);
+        int cz = pos.z < 0 ? 0 : (pos.z < CHUNK_SIZE_XZ ? 1 : 2);
+        Chunk *source = neighbors[cx][cz];
+        if (source == nullptr) return 0;
+
+        return source->getLightLevels(Vec3i(pos.x - (cx - 1) * CHUNK_SIZE_XZ, pos.y, pos.z - (cz - 1) * CHUNK_SIZE_XZ));
+    };
+
+    auto isOpaque = [&](int x, int y, int z) {
+        return columns.opaque[x + 1][z + 1].test(y);
+    };
+
+    // Flat light of the block in front, for liquids and flora
+    auto getFrontLight = [&](int face, Vec3i pos) {
+        const int *normal = NEIGHBOR_OFFSETS[face];
+        return getVertexLight(getLightLevels(pos + Vec3i(normal[0], normal[1], normal[2])));
+    };
+
+    auto getCell = [&](int face, Vec3i pos) {
+        FaceLight light = getSmoothFaceLight(face, pos, isOpaque, getLightLevels);
+        return FaceCell{ids[getBlockIndex(pos.x, pos.y, pos.z)], light, getFaceAO(face, pos, isOpaque)};
+    };
+
+    // Heights of the sections being rebaked
+    ColumnMask sectionBits;
+    for (int y = 0; y < CHUNK_SIZE_Y; ++y) {
+        if (builder.isSectionIncluded(y / CHUNK_SECTION_SIZE)) sectionBits.set(y);
+    }
+
+    for (int face = 0; face < 6; ++face) {
+        const int normalAxis = FACE_AXES[face][0];
+        const int uAxis = FACE_AXES[face][1];
+        const int vAxis = FACE_AXES[face][2];
+        const int sizeU = AXIS_SIZES[uAxis];
+        const int sizeV = AXIS_SIZES[vAxis];
+        const int *offset = NEIGHBOR_OFFSETS[face];
+
+        std::fill(planes.begin(), planes.end(), 0);
+
+        for (int x = 0; x < CHUNK_SIZE_XZ; ++x) {
+            for (int z = 0; z < CHUNK_SIZE_XZ; ++z) {
+                const ColumnMask &opaque = columns.opaque[x + 1][z + 1];
+                const ColumnMask &liquid = columns.liquid[x + 1][z + 1];
+                const ColumnMask &empty = columns.empty[x + 1][z + 1];
+
+                ColumnMask opaqueVisible;
+                ColumnMask liquidVisible;
+                if (face == FACE_TOP) {
+                    opaqueVisible = opaque & ~opaque.above();
+                    liquidVisible = liquid & (empty.above() | TOP_BIT);
+                } else if (face == FACE_BOTTOM) {
+                    // Skip bottom face for bottom block
+                    opaqueVisible = opaque & ~(opaque.below() | BOTTOM_BIT);
+                    liquidVisible = liquid & empty.below();
+                } else {
+                    int nx = x + 1 + offset[0];
+                    int nz = z + 1 + offset[2];
+                    opaqueVisible = opaque & ~columns.opaque[nx][nz];
+                    liquidVisible = liquid & columns.empty[nx][nz];
+                }
+
+                opaqueVisible = opaqueVisible & sectionBits;
+                liquidVisible = liquidVisible & sectionBits;
+
+                opaqueVisible.forEach([&](int y) {
+                    int pos[3] = {x, y, z};
+                    planes[pos[normalAxis] * sizeV + pos[vAxis]] |= 1 << pos[uAxis];
+                });
+
+                // Keep liquids per block, water waves need the vertices
+                liquidVisible.forEach([&](int y) {
+                    FaceLight light = getFlatFaceLight(getFrontLight(face, Vec3i(x, y, z)));
+                    builder.addFace(ids[getBlockIndex(x, y, z)], face, Vec3i(x, y, z), 1, 1, light);
+                });
+            }
+        }
+
+        for (int slice = 0; slice < AXIS_SIZES[normalAxis]; ++slice) {
+            uint16_t *rows = &planes[slice * sizeV];
+
+            auto getPlanePos = [&](int u, int v) {
+                int pos[3];
+                pos[normalAxis] = slice;
+                pos[uAxis] = u;
+                pos[vAxis] = v;
+                return Vec3i(pos[0], pos[1], pos[2]);
+            };
+
+            for (int v = 0; v < sizeV; ++v) {
+                while (rows[v]) {
+                    int u = std::countr_zero(rows[v]);
+                    FaceCell cell = getCell(face, getPlanePos(u, v));
+
+                    // Equal cells with AO or light changing along an axis can't be stretched along it
+                    int maxU = isAOFlatAlongU(cell.ao) && isLightFlatAlongU(cell.light) ? sizeU : u + 1;
+                    int maxV = isAOFlatAlongV(cell.ao) && isLightFlatAlongV(cell.light) ? sizeV : v + 1;
+
+                    int width = 1;
+                    while (u + width < maxU && (rows[v] >> (u + width) & 1) && getCell(face, getPlanePos(u + width, v)) == cell) width++;
+
+                    uint16_t run = ((1u << width) - 1) << u;
+
+                    // Quads stay inside their section
+                    int height = 1;
+                    for (; v + height < maxV && (rows[v + height] & run) == run; ++height) {
+                        if (vAxis == 1 && (v + height) % CHUNK_SECTION_SIZE == 0) break;
+
+                        bool isRowMatches = true;
+                        for (int k = 0; k < width; ++k) {
+                            if (!(getCell(face, getPlanePos(u + k, v + height)) == cell)) {
+                                isRowMatches = false;
+                                break;
+                            }
+                        }
+                        if (!isRowMatches) break;
+                    }
+
+                    for (int dv = 0; dv < height; ++dv) {
+                        rows[v + dv] &= ~run;
+                    }
+
+                    builder.addFace(cell.id, face, getPlanePos(u, v), width, height, cell.light, cell.ao);
+                }
+            }
+        }
+    }
+
+    // Flora has own geometry, once per block
+    for (const Vec3i &pos: flora) {
+        builder.addFlora(ids[getBlockIndex(pos.x, pos.y, pos.z)], pos, getFrontLight(FACE_TOP, pos));
+    }
+}
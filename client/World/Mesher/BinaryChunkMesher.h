@@ -0,0 +1,17 @@
+#ifndef BINARYCHUNKMESHER_H
+#define BINARYCHUNKMESHER_H
+
+#include "AbstractChunkMesher.h"
+
+/**
+ * Culls faces on 128-bit column masks with shifts and AND-NOTs,
+ * then merges quads greedily on the resulting bit planes
+ */
+class BinaryChunkMesher: public AbstractChunkMesher {
+public:
+    [[nodiscard]] const char *getName() const override { return "Binary"; }
+
+    void bake(Chunk *chunk, BlocksSource *blocksSource, ChunkMeshBuilder &builder) override;
+};
+
+#endif //BINARYCHUNKMESHER_H
@@ -0,0 +1,131 @@
+#include "ChunkMeshBuilder.h"
+
+#include <algorithm>
+
+#include "../BlocksIds.h"
+#include "../ChunkVertexPool.h"
+
+struct FaceLayout {
+    int origin[3]; // Corner of the block the quad starts from
+    int u[3];      // Width direction, texture U
+    int v[3];      // Height direction, texture V
+    bool isReversed; // Winding, so the front side looks outside
+};
+
+// Normals and texture coordinates are restored from the face in the shaders
+static const FaceLayout FACE_LAYOUTS[6] = {
+    { {0, 0, 0}, {1, 0, 0}, {0, 1, 0}, true },  // front
+    { {0, 0, 1}, {1, 0, 0}, {0, 1, 0}, false }, // back
+    { {0, 0, 0}, {1, 0, 0}, {0, 0, 1}, false }, // bottom
+    { {0, 1, 0}, {1, 0, 0}, {0, 0, 1}, true },  // top
+    { {0, 0, 0}, {0, 0, 1}, {0, 1, 0}, false }, // left
+    { {1, 0, 0}, {0, 0, 1}, {0, 1, 0}, true },  // right
+};
+
+static void pushVertex(std::vector<ChunkVertex> &vertices, BlockID id, int x, int y, int z, int face, int corner, uint32_t light, int ao = 3) {
+    ChunkVertex vertex;
+    vertex.data = x | (y << 5) | (z << 13) | (face << 18) | (corner << 21) | (ao << 23);
+    vertex.light = light | (id << 24);
+    vertices.push_back(vertex);
+}
+
+// Flora isn't solid in block data either, but is drawn with the solid pass
+static bool isLiquid(BlockID id) {
+    const BlockData *data = getBlockData(id);
+    return data != nullptr && !data->isSolid && !data->isFlora;
+}
+
+// Corner order of a quad, QuadIndexBuffer draws 0-1-2-2-3-0
+static const int FRONT_CORNERS[4] = {0, 1, 2, 3};
+static const int BACK_CORNERS[4] = {2, 1, 0, 3};
+
+ChunkMeshBuilder::ChunkMeshBuilder(uint8_t sectionMask): sectionMask(sectionMask), passVertices(getThreadPassVertices()) {
+    for (auto &sectionVertices: passVertices) {
+        for (auto &faceVertices: sectionVertices) {
+            for (auto &vertices: faceVertices) {
+                vertices.clear();
+            }
+        }
+    }
+}
+
+ChunkMeshBuilder::PassVertices &ChunkMeshBuilder::getThreadPassVertices() {
+    static thread_local PassVertices passVertices;
+    return passVertices;
+}
+
+static int getCornerAO(int ao, int corner) {
+    return (ao >> (corner * 2)) & 3;
+}
+
+void ChunkMeshBuilder::addFace(BlockID id, int face, Vec3i origin, int width, int height, const FaceLight &light, int ao) {
+    int section = origin.y / CHUNK_SECTION_SIZE;
+    if (!isSectionIncluded(section)) return;
+
+    const FaceLayout &layout = FACE_LAYOUTS[face];
+    std::vector<ChunkVertex> &vertices = passVertices[section][isLiquid(id) ? CHUNK_PASS_LIQUID : CHUNK_PASS_SOLID][face];
+    const int corners[4][2] = { {0, 0}, {width, 0}, {width, height}, {0, height} };
+
+    const int *order = layout.isReversed ? BACK_CORNERS : FRONT_CORNERS;
+
+    // Triangles share the diagonal from the first vertex to the third one. Keep it between
+    // the brighter pair of corners, so a dark corner shades only its own triangle
+    int rotation = 0;
+    if (getCornerAO(ao, 0) + getCornerAO(ao, 2) < getCornerAO(ao, 1) + getCornerAO(ao, 3)) rotation = 1;
+
+    for (int k = 0; k < 4; ++k) {
+        int i = order[(k + rotation) % 4];
+        int x = origin.x + layout.origin[0] + layout.u[0] * corners[i][0] + layout.v[0] * corners[i][1];
+        int y = origin.y + layout.origin[1] + layout.u[1] * corners[i][0] + layout.v[1] * corners[i][1];
+        int z = origin.z + layout.origin[2] + layout.u[2] * corners[i][0] + layout.v[2] * corners[i][1];
+        pushVertex(vertices, id, x, y, z, face, i, light[i], getCornerAO(ao, i));
+    }
+}
+
+void ChunkMeshBuilder::addFlora(BlockID id, Vec3i origin, uint32_t light) {
+    int section = origin.y / CHUNK_SECTION_SIZE;
+    if (!isSectionIncluded(section)) return;
+
+    pushVertex(passVertices[section][CHUNK_PASS_FLORA][0], id, origin.x, origin.y, origin.z, VERTEX_FACE_FLORA, 0, light);
+}
+
+// Stable pseudo-random order of plants, any prefix of it is spread over the section
+static uint32_t getFloraOrder(const ChunkVertex &vertex) {
+    uint32_t hash = vertex.data * 0x9E3779B1u;
+    return hash ^ (hash >> 16);
+}
+
+void ChunkMeshBuilder::buildParts(BakedChunk *bakedChunk) {
+    bakedChunk->sectionMask = sectionMask;
+
+    for (int section = 0; section < CHUNK_SECTIONS; ++section) {
+        if (!isSectionIncluded(section)) continue;
+
+        for (int pass = 0; pass < CHUNK_PASS_COUNT; ++pass) {
+            auto &faceVertices = passVertices[section][pass];
+            BakedChunkPart &part = bakedChunk->parts[section][pass];
+
+            // Flora gets thinned out with distance by drawing fewer plants
+            if (pass == CHUNK_PASS_FLORA) {
+                std::sort(faceVertices[0].begin(), faceVertices[0].end(), [](const ChunkVertex &a, const ChunkVertex &b) {
+                    return getFloraOrder(a) < getFloraOrder(b);
+                });
+            }
+
+            size_t vertexCount = 0;
+            for (const auto &vertices: faceVertices) {
+                vertexCount += vertices.size();
+            }
+
+            // Face buckets one after another, so the renderer can skip directions.
+            // The buffer goes to the GPU as is and comes back to the pool after
+            if (vertexCount > 0) part.vertices = ChunkVertexPool::shared().acquire(vertexCount);
+            const size_t elementVertices = CHUNK_PASS_ELEMENT_VERTICES(pass);
+            for (int face = 0; face < 6; ++face) {
+                part.faceFirstElements[face] = part.vertices.size() / elementVertices;
+                part.vertices.insert(part.vertices.end(), faceVertices[face].begin(), faceVertices[face].end());
+            }
+            part.faceFirstElements[6] = part.vertices.size() / elementVertices;
+        }
+    }
+}
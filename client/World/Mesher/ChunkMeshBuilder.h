@@ -0,0 +1,63 @@
+#ifndef CHUNKMESHBUILDER_H
+#define CHUNKMESHBUILDER_H
+
+#include <array>
+#include <vector>
+
+#include "../../GL/glad.h"
+#include "../../Math/Vec3i.h"
+#include "../BakedChunk.h"
+#include "../BlocksIds.h"
+
+#define FACE_FRONT 0
+#define FACE_BACK 1
+#define FACE_BOTTOM 2
+#define FACE_TOP 3
+#define FACE_LEFT 4
+#define FACE_RIGHT 5
+
+// Ambient occlusion of face corners, 2 bits per corner in addFace order: 0 - darkest, 3 - open
+#define FACE_AO_OPEN 0xFF
+
+// Vertex light in quarter levels, 6 bits per channel: red | green | blue | sky
+#define VERTEX_LIGHT_CHANNEL_BITS 6
+
+// Vertex light of the face corners in addFace order
+using FaceLight = std::array<uint32_t, 4>;
+
+/**
+ * Collects chunk geometry grouped by section and render pass, block textures are picked per vertex
+ */
+class ChunkMeshBuilder {
+    // Bucket per face direction, flora has no direction and stays in the first one
+    using PassVertices = std::vector<ChunkVertex>[CHUNK_SECTIONS][CHUNK_PASS_COUNT][6];
+
+    uint8_t sectionMask;
+
+    // Scratch of the baking thread, keeps its capacity between bakes. One builder per thread at a time
+    PassVertices &passVertices;
+
+    static PassVertices &getThreadPassVertices();
+public:
+    explicit ChunkMeshBuilder(uint8_t sectionMask = CHUNK_ALL_SECTIONS);
+
+    // Meshers skip sections that aren't rebaked, quads must not cross section borders
+    [[nodiscard]] bool isSectionIncluded(int section) const {
+        return sectionMask & (1 << section);
+    }
+
+    [[nodiscard]] uint8_t getSectionMask() const {
+        return sectionMask;
+    }
+
+    // Quad covering width x height block faces, starting at origin block (chunk-local).
+    // Corners go (0, 0), (width, 0), (width, height), (0, height) along the face axes.
+    void addFace(BlockID id, int face, Vec3i origin, int width, int height, const FaceLight &light, int ao = FACE_AO_OPEN);
+
+    // Plant standing in the origin block, one vertex that is drawn as two crossed quads
+    void addFlora(BlockID id, Vec3i origin, uint32_t light);
+
+    void buildParts(BakedChunk *bakedChunk);
+};
+
+#endif //CHUNKMESHBUILDER_H
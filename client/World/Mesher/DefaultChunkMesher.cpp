@@ -0,0 +1,41 @@
+#include "DefaultChunkMesher.h"
+
+void DefaultChunkMesher::bake(Chunk *chunk, BlocksSource *blocksSource, ChunkMeshBuilder &builder) {
+    for (int x = 0; x < CHUNK_SIZE_XZ; ++x) {
+        for (int y = 0; y < CHUNK_SIZE_Y; ++y) {
+            if (!builder.isSectionIncluded(y / CHUNK_SECTION_SIZE)) continue;
+
+            for (int z = 0; z < CHUNK_SIZE_XZ; ++z) {
+                Block *currentBlock = chunk->getBlock(Vec3i(x, y, z));
+                if (currentBlock == nullptr || currentBlock->getId() == BLOCK_AIR) continue;
+
+                if (currentBlock->isFlora()) { // Flora has different geometry
+                    uint32_t light = getVertexLight(getFaceLight(chunk, currentBlock, FACE_TOP, blocksSource));
+                    builder.addFlora(currentBlock->getId(), Vec3i(x, y, z), light);
+                    continue;
+                }
+
+                // Check each block's neighbors to determine which faces should be visible
+                for (int face = 0; face < 6; ++face) {
+
+                    // Check if the neighboring block exists or is air (to render the face)
+                    const int *offset = NEIGHBOR_OFFSETS[face];
+                    Block *neighborBlock = getNeighborBlock(chunk, blocksSource, Vec3i(x + offset[0], y + offset[1], z + offset[2]));
+
+                    if (isFaceVisible(currentBlock, neighborBlock, face)) {
+                        // Liquids keep flat light and no occlusion
+                        if (!currentBlock->isSolid()) {
+                            uint32_t light = getVertexLight(getFaceLight(chunk, currentBlock, face, blocksSource));
+                            builder.addFace(currentBlock->getId(), face, Vec3i(x, y, z), 1, 1, getFlatFaceLight(light));
+                            continue;
+                        }
+
+                        FaceLight light = getSmoothFaceLight(chunk, blocksSource, face, Vec3i(x, y, z));
+                        int ao = getFaceAO(chunk, blocksSource, face, Vec3i(x, y, z));
+                        builder.addFace(currentBlock->getId(), face, Vec3i(x, y, z), 1, 1, light, ao);
+                    }
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,16 @@
+#ifndef DEFAULTCHUNKMESHER_H
+#define DEFAULTCHUNKMESHER_H
+
+#include "AbstractChunkMesher.h"
+
+/**
+ * One quad per visible block face
+ */
+class DefaultChunkMesher: public AbstractChunkMesher {
+public:
+    [[nodiscard]] const char *getName() const override { return "Default"; }
+
+    void bake(Chunk *chunk, BlocksSource *blocksSource, ChunkMeshBuilder &builder) override;
+};
+
+#endif //DEFAULTCHUNKMESHER_H
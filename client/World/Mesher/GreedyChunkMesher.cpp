@@ -0,0 +1,117 @@
+#include "GreedyChunkMesher.h"
+
+struct FaceCell {
+    BlockID id;
+    FaceLight light;
+    int ao;
+
+    bool operator==(const FaceCell &other) const {
+        return id == other.id && light == other.light && ao == other.ao;
+    }
+};
+
+void GreedyChunkMesher::bake(Chunk *chunk, BlocksSource *blocksSource, ChunkMeshBuilder &builder) {
+    // Reused by bakes of the same thread, every cell is written before it is read
+    static thread_local std::vector<FaceCell> mask(CHUNK_SIZE_XZ * CHUNK_SIZE_Y);
+
+    for (int face = 0; face < 6; ++face) {
+        const int normalAxis = FACE_AXES[face][0];
+        const int uAxis = FACE_AXES[face][1];
+        const int vAxis = FACE_AXES[face][2];
+        const int sizeU = AXIS_SIZES[uAxis];
+        const int sizeV = AXIS_SIZES[vAxis];
+        const int *offset = NEIGHBOR_OFFSETS[face];
+
+        for (int slice = 0; slice < AXIS_SIZES[normalAxis]; ++slice) {
+            // Collect visible faces of the slice
+            for (int v = 0; v < sizeV; ++v) {
+                for (int u = 0; u < sizeU; ++u) {
+                    FaceCell &cell = mask[u + v * sizeU];
+                    cell = {BLOCK_AIR, {}, FACE_AO_OPEN};
+
+                    int pos[3];
+                    pos[normalAxis] = slice;
+                    pos[uAxis] = u;
+                    pos[vAxis] = v;
+                    Vec3i blockPos = Vec3i(pos[0], pos[1], pos[2]);
+                    if (!builder.isSectionIncluded(blockPos.y / CHUNK_SECTION_SIZE)) continue;
+
+                    Block *currentBlock = chunk->getBlock(blockPos);
+                    if (currentBlock == nullptr || currentBlock->getId() == BLOCK_AIR || currentBlock->isFlora()) continue;
+
+                    Block *neighborBlock = getNeighborBlock(chunk, blocksSource, blockPos + Vec3i(offset[0], offset[1], offset[2]));
+                    if (!isFaceVisible(currentBlock, neighborBlock, face)) continue;
+
+                    // Keep liquids per block, water waves need the vertices
+                    if (!currentBlock->isSolid()) {
+                        uint32_t light = getVertexLight(getFaceLight(chunk, currentBlock, face, blocksSource));
+                        builder.addFace(currentBlock->getId(), face, blockPos, 1, 1, getFlatFaceLight(light));
+                        continue;
+                    }
+
+                    FaceLight light = getSmoothFaceLight(chunk, blocksSource, face, blockPos);
+                    cell = {currentBlock->getId(), light, getFaceAO(chunk, blocksSource, face, blockPos)};
+                }
+            }
+
+            // Merge equal cells into rectangles, widest first
+            for (int v = 0; v < sizeV; ++v) {
+                for (int u = 0; u < sizeU;) {
+                    FaceCell cell = mask[u + v * sizeU];
+                    if (cell.id == BLOCK_AIR) {
+                        u++;
+                        continue;
+                    }
+
+                    // Equal cells with AO or light changing along an axis can't be stretched along it
+                    int maxU = isAOFlatAlongU(cell.ao) && isLightFlatAlongU(cell.light) ? sizeU : u + 1;
+                    int maxV = isAOFlatAlongV(cell.ao) && isLightFlatAlongV(cell.light) ? sizeV : v + 1;
+
+                    int width = 1;
+                    while (u + width < maxU && mask[u + width + v * sizeU] == cell) width++;
+
+                    // Quads stay inside their section
+                    int height = 1;
+                    for (; v + height < maxV; ++height) {
+                        if (vAxis == 1 && (v + height) % CHUNK_SECTION_SIZE == 0) break;
+
+                        bool isRowMatches = true;
+                        for (int k = 0; k < width; ++k) {
+                            if (!(mask[u + k + (v + height) * sizeU] == cell)) {
+                                isRowMatches = false;
+                                break;
+                            }
+                        }
+                        if (!isRowMatches) break;
+                    }
+
+                    int pos[3];
+                    pos[normalAxis] = slice;
+                    pos[uAxis] = u;
+                    pos[vAxis] = v;
+                    builder.addFace(cell.id, face, Vec3i(pos[0], pos[1], pos[2]), width, height, cell.light, cell.ao);
+
+                    for (int dv = 0; dv < height; ++dv) {
+                        for (int du = 0; du < width; ++du) {
+                            mask[u + du + (v + dv) * sizeU].id = BLOCK_AIR;
+                        }
+                    }
+                    u += width;
+                }
+            }
+        }
+    }
+
+    // Flora has own geometry, once per block
+    for (int x = 0; x < CHUNK_SIZE_XZ; ++x) {
+        for (int y = 0; y < CHUNK_SIZE_Y; ++y) {
+            for (int z = 0; z < CHUNK_SIZE_XZ; ++z) {
+                Block *currentBlock = chunk->getBlock(Vec3i(x, y, z));
+                if (currentBlock == nullptr || !currentBlock->isFlora()) continue;
+
+                uint32_t light = getVertexLight(getFaceLight(chunk, currentBlock, FACE_TOP, blocksSource));
+                builder.addFlora(currentBlock->getId(), Vec3i(x, y, z), light);
+            }
+        }
+    }
+}
@@ -0,0 +1,16 @@
+#ifndef GREEDYCHUNKMESHER_H
+#define GREEDYCHUNKMESHER_H
+
+#include "AbstractChunkMesher.h"
+
+/**
+ * Merges coplanar faces with the same block and light into bigger quads
+ */
+class GreedyChunkMesher: public AbstractChunkMesher {
+public:
+    [[nodiscard]] const char *getName() const override { return "Greedy"; }
+
+    void bake(Chunk *chunk, BlocksSource *blocksSource, ChunkMeshBuilder &builder) override;
+};
+
+#endif //GREEDYCHUNKMESHER_H
@@ -1,10 +1,15 @@
 #include "World.h"
 
+#include "Mesher/DefaultChunkMesher.h"
+#include "Mesher/GreedyChunkMesher.h"
+#include "Mesher/BinaryChunkMesher.h"
+
 World::World(int seedValue, RuntimeConfig *runtimeConfig) {
     this->player = new Player();
     this->seedValue = seedValue;
     this->runtimeConfig = runtimeConfig;
     this->generator = new DefaultWorldGenerator(seedValue);
+    this->meshers = {new DefaultChunkMesher(), new GreedyChunkMesher(), new BinaryChunkMesher()};
 
     for (int i = 0; i < BAKING_CHUNK_THREADS_LIMIT; ++i) {
         threads.emplace_back(&World::updateChunks, this);
@@ -28,8 +33,11 @@ void World::markChunkToUnload(Chunk *chunk) {
 void World::unloadChunk(Chunk *chunk) {
     int hash = chunk->hash;
 
+    // Light passes running later can't find the chunk anymore
+    lightEngine.unloadChunk(chunk, [this, chunk] {
+        std::erase(this->chunks, chunk);
+    });
     delete chunk;
-    std::erase(this->chunks, chunk);
     std::cout << "Chunk #" << hash << " unloaded" << std::endl;
 }
 
@@ -47,6 +55,101 @@ bool World::areNeighborsGenerated(const Vec3i &chunkPos) {
     return true;
 }
 
+bool World::isChunkReadyToBake(Vec3i chunkPos) {
+    // Unloaded chunks are woken as well, so their tasks can finish
+    Chunk *chunk = findChunkByChunkPos(chunkPos);
+    if (chunk == nullptr || chunk->isNeedToUnload) return true;
+
+    return areNeighborsGenerated(chunkPos) && runtimeConfig->isChunkBakingEnabled;
+}
+
+void World::parkNeighborsAwaiter(ChunkNeighborsAwaiter *awaiter) {
+    std::lock_guard lock(neighborsAwaitersMutex);
+    awaiter->next = neighborsAwaiters;
+    neighborsAwaiters = awaiter;
+    ++neighborsAwaitersCount;
+}
+
+void World::wakeNeighborsAwaiters() {
+    std::lock_guard lock(neighborsAwaitersMutex);
+
+    JobQueue::Job **link = &neighborsAwaiters;
+    while (*link) {
+        auto *awaiter = static_cast<ChunkNeighborsAwaiter *>(*link);
+        if (isChunkReadyToBake(awaiter->chunkPos)) {
+            *link = awaiter->next;
+            --neighborsAwaitersCount;
+            workerJobs.post(awaiter);
+        } else {
+            link = &awaiter->next;
+        }
+    }
+}
+
+Task World::loadChunk(Vec3i pos) {
+    generateFilledChunk(pos);
+    // Counted from generation on, chunks waiting for neighbors are not meshed yet either
+    meshStage.forceEnter();
+
+    co_await ChunkNeighborsAwaiter(this, pos);
+
+    // Don't produce meshes faster than the renderer uploads them
+    co_await uploadStage.enter(&workerJobs);
+    meshStage.leave();
+
+    // Chunk could be unloaded while waiting
+    Chunk *chunk = findChunkByChunkPos(pos);
+    if (chunk == nullptr || chunk->isNeedToUnload) {
+        uploadStage.leave();
+        co_return;
+    }
+
+    bakeAndPublish(chunk);
+}
+
+void World::rebakeChunk(Vec3i pos) {
+    Chunk *chunk = findChunkByChunkPos(pos);
+    if (chunk == nullptr) return;
+
+    // Edits skip the queue, but still count towards it
+    uploadStage.forceEnter();
+    bakeAndPublish(chunk);
+}
+
+// Caller holds a slot in the upload stage, the mesh takes it over
+void World::bakeAndPublish(Chunk *chunk) {
+    BakedChunk *bakedChunk = chunk->bakeChunk(this, getMesher());
+    bakedChunk->uploadSlot = &uploadStage;
+    averageBakeTimeMs = averageBakeTimeMs * 0.9f + bakedChunk->bakeDurationMs * 0.1f;
+    if (chunk->version != bakedChunk->version) {
+        ++countOfStaleBakes;
+    }
+    completedMeshes.push(bakedChunk);
+}
+
+AbstractChunkMesher *World::getMesher() const {
+    return meshers[runtimeConfig->chunkMesher];
+}
+
+void World::requestRebakeAll() {
+    for (Chunk *chunk: chunks) {
+        chunk->requestRebake();
+    }
+}
+
+void World::publishCompletedMeshes() {
+    BakedChunk *bakedChunk = completedMeshes.takeAll();
+    while (bakedChunk) {
+        BakedChunk *next = bakedChunk->next;
+        if (Chunk *chunk = findChunkByChunkPos(bakedChunk->chunkPos)) {
+            chunk->setPendingBakedChunk(bakedChunk);
+        } else {
+            delete bakedChunk;
+        }
+        bakedChunk = next;
+    }
+}
+
 void World::updateChunks() {
     while (true) {
         // Vec3i playerPos = {static_cast<int>(this->player->position.x), static_cast<int>(this->player->position.y), static_cast<int>(this->player->position.z)};
@@ -55,6 +158,10 @@ void World::updateChunks() {
             static_cast<int>(this->player->getPosition().z / CHUNK_SIZE_XZ)
         };
 
+        // Resume chunk tasks
+        wakeNeighborsAwaiters();
+        workerJobs.runPending();
+
         // Find not generated chunks around player
         auto maxDistance = runtimeConfig->maxRenderingDistance;
         bool isFound = false;
@@ -64,8 +171,6 @@ void World::updateChunks() {
             for (int z = -maxDistance; z < maxDistance; z++) {
                 Vec3i chunkPos = playerChunkPos + Vec3i(x, 0, z);
                 if (!isChunkExist(chunkPos)) {
-                    // generateFilledChunk(chunkPos);
-
                     auto distance = playerChunkPos.distanceTo(chunkPos);
                     if (distance < targetChunkDistance && distance < maxDistance) {
                         targetChunkDistance = distance;
@@ -76,8 +181,13 @@ void World::updateChunks() {
             }
         }
 
-        if (isFound && this-runtimeConfig->isChunkGenerationEnabled) {
-            generateFilledChunk(targetChunkPos);
+        // Don't generate faster than chunks are meshed. A stage full of chunks waiting for
+        // neighbors only drains by generating those neighbors, so that doesn't count as behind
+        bool isMeshingBehind = meshStage.isFull() && meshStage.getDepth() > neighborsAwaitersCount;
+        meshStage.setProducerStalled(isFound && isMeshingBehind);
+
+        if (isFound && !isMeshingBehind && this->runtimeConfig->isChunkGenerationEnabled) {
+            loadChunk(targetChunkPos);
         }
 
         for (Chunk *chunk: chunks) {
@@ -87,8 +197,9 @@ void World::updateChunks() {
                 markChunkToUnload(chunk);
             }
 
-            if ((!chunk->isBaked() || chunk->isNeedToRebake) && areNeighborsGenerated(chunkPos) && !chunk->isNeedToUnload && this-runtimeConfig->isChunkBakingEnabled) {
-                chunk->bakeChunk(this);
+            // First bake belongs to the chunk task, this handles edits only
+            if (chunk->isNeedToRebake() && chunk->isBaked() && areNeighborsGenerated(chunkPos) && !chunk->isNeedToUnload && this->runtimeConfig->isChunkBakingEnabled) {
+                rebakeChunk(chunkPos);
             }
         }
     }
@@ -97,7 +208,11 @@ void World::updateChunks() {
 void World::generateFilledChunk(Vec3i pos) {
     auto *chunk = new Chunk(pos);
     this->generator->generateChunk(chunk);
+    LightEngine::initSkyLight(chunk);
     chunks.push_back(chunk);
+
+    // Light doesn't wait for neighbors, light of missing ones gets in when they are generated
+    lightEngine.lightChunk(chunk);
 }
 
 
@@ -126,28 +241,88 @@ void World::setBlock(BlockID id, Vec3i worldPos) {
     // TODO: Calculate chunk pos instead of searching
     for (Chunk *chunk : this->chunks) {
         if (chunk->isBlockInBounds(worldPos)) {
-            Vec3i blockInChunkPos = worldPos - (chunk->position * CHUNK_SIZE_XZ);
-            chunk->setBlock(id, blockInChunkPos);
-            chunk->requestRebake();
-
-            // Update neighbors chunk
-            Vec3i chunkPos = chunk->position;
-            if (blockInChunkPos.x == 0) {
-                chunkPos = chunkPos + Vec3i(-1, 0, 0);
-            } else if (blockInChunkPos.x == CHUNK_SIZE_XZ - 1) {
-                chunkPos = chunkPos + Vec3i(1, 0, 0);
-            } else if (blockInChunkPos.z == 0) {
-                chunkPos = chunkPos + Vec3i(0, 0, -1);
-            } else if (blockInChunkPos.z == CHUNK_SIZE_XZ - 1) {
-                chunkPos = chunkPos + Vec3i(0, 0, 1);
+            LightEdit lightEdit;
+            if (replaceBlock(chunk, id, worldPos - (chunk->position * CHUNK_SIZE_XZ), lightEdit)) {
+                lightEngine.relightBlock(chunk, lightEdit.pos, lightEdit.wasOpaque, lightEdit.oldEmission);
             }
+            return;
+        }
+    }
+}
+
+void World::setBlocks(BlockID id, const std::vector<Vec3i> &positions) {
+    // Edits are collected per chunk, light passes run once all blocks are in place
+    std::vector<std::pair<Chunk *, std::vector<LightEdit>>> chunkEdits;
+    Chunk *chunk = nullptr;
+    std::vector<LightEdit> *edits = nullptr;
 
-            if (chunkPos != chunk->position) {
-                if (Chunk *chunk = findChunkByChunkPos(chunkPos)) {
-                    chunk->requestRebake();
+    for (const Vec3i &worldPos: positions) {
+        if (chunk == nullptr || !chunk->isBlockInBounds(worldPos)) {
+            chunk = nullptr;
+            for (Chunk *candidate: this->chunks) {
+                if (candidate->isBlockInBounds(worldPos)) {
+                    chunk = candidate;
+                    break;
                 }
             }
-            return;
+            if (chunk == nullptr) continue;
+
+            auto found = std::find_if(chunkEdits.begin(), chunkEdits.end(), [&](const auto &entry) {
+                return entry.first == chunk;
+            });
+            if (found == chunkEdits.end()) found = chunkEdits.insert(chunkEdits.end(), {chunk, {}});
+            edits = &found->second;
+        }
+
+        LightEdit lightEdit;
+        if (replaceBlock(chunk, id, worldPos - (chunk->position * CHUNK_SIZE_XZ), lightEdit)) {
+            edits->push_back(lightEdit);
         }
     }
+
+    for (const auto &[editedChunk, lightEdits]: chunkEdits) {
+        lightEngine.relightBlocks(editedChunk, lightEdits);
+    }
+}
+
+bool World::replaceBlock(Chunk *chunk, BlockID id, Vec3i blockInChunkPos, LightEdit &lightEdit) {
+    Block *oldBlock = chunk->getBlock(blockInChunkPos);
+    BlockID oldId = oldBlock ? oldBlock->getId() : BLOCK_AIR;
+    bool isOldOpaque = oldBlock != nullptr && oldBlock->isOpaque();
+    chunk->setBlock(id, blockInChunkPos);
+    Block *newBlock = chunk->getBlock(blockInChunkPos);
+    bool isNewOpaque = newBlock != nullptr && newBlock->isOpaque();
+
+    // Faces touching the block change, so do sections next to it
+    int y = blockInChunkPos.y;
+    chunk->requestRebake(Chunk::getSectionsInRange(y - 1, y + 1));
+
+    // Update neighbors chunks, a corner block touches three of them. Faces next to the block change,
+    // ambient occlusion reaches one block up and down
+    uint8_t neighborSections = Chunk::getSectionsInRange(y - 1, y + 1);
+    Vec3i neighborOffset = Vec3i(0, 0, 0);
+    if (blockInChunkPos.x == 0) neighborOffset.x = -1;
+    else if (blockInChunkPos.x == CHUNK_SIZE_XZ - 1) neighborOffset.x = 1;
+    if (blockInChunkPos.z == 0) neighborOffset.z = -1;
+    else if (blockInChunkPos.z == CHUNK_SIZE_XZ - 1) neighborOffset.z = 1;
+
+    if (neighborOffset.x != 0) {
+        if (Chunk *neighbor = findChunkByChunkPos(chunk->position + Vec3i(neighborOffset.x, 0, 0))) {
+            neighbor->requestRebake(neighborSections);
+        }
+    }
+    if (neighborOffset.z != 0) {
+        if (Chunk *neighbor = findChunkByChunkPos(chunk->position + Vec3i(0, 0, neighborOffset.z))) {
+            neighbor->requestRebake(neighborSections);
+        }
+    }
+    if (neighborOffset.x != 0 && neighborOffset.z != 0) {
+        if (Chunk *neighbor = findChunkByChunkPos(chunk->position + neighborOffset)) {
+            neighbor->requestRebake(neighborSections);
+        }
+    }
+
+    // Light rebakes the sections it changes
+    lightEdit = {blockInChunkPos, isOldOpaque, getBlockEmission(oldId)};
+    return isOldOpaque != isNewOpaque || getBlockEmission(oldId) != getBlockEmission(id);
 }
\ No newline at end of file
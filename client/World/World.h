@@ -13,20 +13,80 @@
 #include "../utils/RuntimeConfig.h"
 #include "Generator/AbstractWorldGenerator.h"
 #include "Generator/DefaultWorldGenerator.h"
+#include "Mesher/AbstractChunkMesher.h"
+#include "Light/LightEngine.h"
+#include "../Jobs/Task.h"
+#include "../Jobs/JobQueue.h"
+#include "../Jobs/BoundedStage.h"
+#include "../Jobs/MpscQueue.h"
 
 class World: public BlocksSource {
 private:
     std::vector<std::thread> threads;
 
     std::mutex mutex;
+
+    // Parks a chunk task until all 4 neighbors are generated
+    struct ChunkNeighborsAwaiter: JobQueue::Job {
+        World *world;
+        Vec3i chunkPos;
+
+        ChunkNeighborsAwaiter(World *world, Vec3i chunkPos): world(world), chunkPos(chunkPos) {}
+
+        bool await_ready() const {
+            return world->isChunkReadyToBake(chunkPos);
+        }
+
+        void await_suspend(std::coroutine_handle<> handle) {
+            this->handle = handle;
+            world->parkNeighborsAwaiter(this);
+        }
+
+        void await_resume() const noexcept {}
+    };
+
+    std::mutex neighborsAwaitersMutex;
+    JobQueue::Job *neighborsAwaiters = nullptr; // List of ChunkNeighborsAwaiter
+    std::atomic<int> neighborsAwaitersCount = 0;
+
+    void parkNeighborsAwaiter(ChunkNeighborsAwaiter *awaiter);
+    void wakeNeighborsAwaiters();
+    bool isChunkReadyToBake(Vec3i chunkPos);
+
+    // Chunk lifecycle: generate and light, wait for neighbors, bake, hand mesh to the render thread
+    Task loadChunk(Vec3i pos);
+    void rebakeChunk(Vec3i pos);
+    void bakeAndPublish(Chunk *chunk);
+
+    // Writes a block and rebakes sections around it. Returns true if light has to be updated, the edit tells how
+    bool replaceBlock(Chunk *chunk, BlockID id, Vec3i blockInChunkPos, LightEdit &lightEdit);
+
+    // Meshes finished by bakers, drained by the render thread
+    MpscQueue<BakedChunk> completedMeshes;
 public:
     Player *player;
     int seedValue;
     AbstractWorldGenerator *generator;
+    std::vector<AbstractChunkMesher *> meshers;
+    std::atomic<float> averageBakeTimeMs = 0.0f;
+    // Bakes outdated by an edit before they finished, each one is followed by a rebake
+    std::atomic<int> countOfStaleBakes = 0;
     std::vector<Chunk *> chunks;
+    LightEngine lightEngine = LightEngine(this);
 
     RuntimeConfig *runtimeConfig;
 
+    // Executor of chunk tasks, drained by the chunk threads
+    JobQueue workerJobs;
+
+    // Swaps finished meshes into their chunks, render thread only, once per frame
+    void publishCompletedMeshes();
+
+    // Generated chunks not meshed yet, including ones waiting for neighbors. Generation stalls while full
+    BoundedStage meshStage = BoundedStage(MESH_STAGE_CAPACITY);
+    // Baked meshes not uploaded yet, baking stalls while full
+    BoundedStage uploadStage = BoundedStage(UPLOAD_STAGE_CAPACITY);
+
     World(int seedValue, RuntimeConfig *runtimeConfig);
 
     int xx = 0;
@@ -40,14 +100,20 @@ public:
     // TODO: Review all allocable things
     void unloadChunk(Chunk *chunk);
 
-    Chunk* findChunkByChunkPos(Vec3i pos);
+    Chunk* findChunkByChunkPos(Vec3i pos) override;
     bool areNeighborsGenerated(const Vec3i &chunkPos);
     void updateChunks();
 
     void generateFilledChunk(Vec3i pos);
 
+    [[nodiscard]] AbstractChunkMesher *getMesher() const;
+    void requestRebakeAll();
+
     Block *getBlock(Vec3i pos) override;
     void setBlock(BlockID id, Vec3i pos) override;
+
+    // Sets many blocks at once, light of each chunk is updated in one pass after all of them
+    void setBlocks(BlockID id, const std::vector<Vec3i> &positions);
 };
 
 #endif //H_WORLD
@@ -1,5 +1,22 @@
 #define CHUNK_SIZE_XZ 16
 #define CHUNK_SIZE_Y 128
+#define CHUNK_VOLUME (CHUNK_SIZE_XZ * CHUNK_SIZE_Y * CHUNK_SIZE_XZ)
+// Light is stored as a nibble per color: red, green and blue block light, then sky light.
+// The block light channel holds the three colors packed, the sky light channel one level
+#define LIGHT_CHANNEL_BLOCK 0
+#define LIGHT_CHANNEL_SKY 1
+#define LIGHT_BLOCK_MASK 0x0FFF
+#define LIGHT_SKY_SHIFT 12
+#define LIGHT_LEVEL_MAX 15
+// Block light of the three colors packed as in Chunk::light
+#define LIGHT_COLOR(red, green, blue) ((red) | (green) << 4 | (blue) << 8)
+// Chunk meshes are stored and rebaked by 16x16x16 sections, a bit per section in masks
+#define CHUNK_SECTION_SIZE 16
+#define CHUNK_SECTIONS (CHUNK_SIZE_Y / CHUNK_SECTION_SIZE)
+#define CHUNK_ALL_SECTIONS ((1 << CHUNK_SECTIONS) - 1)
 // #define CHUNK_RENDERING_DISTANCE 6
 // #define CHUNK_RENDERING_DISTANCE_IN_BLOCKS (CHUNK_RENDERING_DISTANCE * CHUNK_SIZE_XZ)
-#define BAKING_CHUNK_THREADS_LIMIT 1
\ No newline at end of file
+#define BAKING_CHUNK_THREADS_LIMIT 1
+// Back-pressure between chunk pipeline stages
+#define MESH_STAGE_CAPACITY 16
+#define UPLOAD_STAGE_CAPACITY 8
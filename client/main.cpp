@@ -99,6 +99,45 @@ GLuint loadImageToGPU(std::string fileName) {
     return textureName;
 }
 
+// Loads all block textures as layers of one array, the layer is the block id
+GLuint loadBlocksTextureArray() {
+    BlockID maxBlockID = 0;
+    for (const BlockData& data: BLOCKS_DATA) {
+        maxBlockID = std::max(maxBlockID, data.blockID);
+    }
+
+    GLuint textureName;
+    glGenTextures(1, &textureName);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, textureName);
+
+    bool isAllocated = false;
+    for (const BlockData& data: BLOCKS_DATA) {
+        Image *image = Image::load(data.name);
+
+        // All block textures have the same size
+        if (!isAllocated) {
+            glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, image->width, image->height, maxBlockID + 1, 0, GL_RGBA,
+                         GL_UNSIGNED_BYTE, nullptr);
+            isAllocated = true;
+        }
+
+        // Image is always loaded as RGBA
+        glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, data.blockID, image->width, image->height, 1, GL_RGBA,
+                        GL_UNSIGNED_BYTE, image->raw);
+
+        stbi_image_free(image->raw);
+        delete image;
+    }
+    glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+    return textureName;
+}
+
 void GLAPIENTRY
 MessageCallback( GLenum source,
                  GLenum type,
@@ -213,6 +252,11 @@ int main() {
     runtimeConfig.maxRenderingDistance = 6;
     runtimeConfig.isChunkGenerationEnabled = true;
     runtimeConfig.isChunkBakingEnabled = true;
+    runtimeConfig.uploadBudgetKb = 512;
+    runtimeConfig.chunkMesher = 0;
+    runtimeConfig.floraFullDensityDistance = 48;
+    runtimeConfig.timeOfDay = 12.0f;
+    runtimeConfig.isLightTextureEnabled = false;
 
     SDL_Init(SDL_INIT_VIDEO);
     SDL_Window *window = SDL_CreateWindow("Crafteria", 1400, 900, SDL_WINDOW_OPENGL);
@@ -231,6 +275,11 @@ int main() {
         return -1;
     }
 
+    // GLAD is generated for GL 3.2, instanced attributes are core since 3.3 (flora)
+    if (glad_glVertexAttribDivisor == nullptr) {
+        glad_glVertexAttribDivisor = (PFNGLVERTEXATTRIBDIVISORPROC) SDL_GL_GetProcAddress("glVertexAttribDivisor");
+    }
+
     std::cout << std::setw(34) << std::left << "OpenGL Version: " << GLVersion.major << "." << GLVersion.minor << std::endl;
     std::cout << std::setw(34) << std::left << "OpenGL Shading Language Version: " << (char *)glGetString(GL_SHADING_LANGUAGE_VERSION) << std::endl;
     std::cout << std::setw(34) << std::left << "OpenGL Vendor:" << (char *)glGetString(GL_VENDOR) << std::endl;
@@ -255,7 +304,7 @@ int main() {
     // glEnable(GL_DEBUG_OUTPUT);
     // glDebugMessageCallback(MessageCallback, 0);
 
-    // Loading images and store texture names
+    // Loading images and store texture names, for the hotbar
     // FIXME(hax): I think this is bad way
     std::unordered_map<BlockID, GLuint> glTextures;
     for (const BlockData& data: BLOCKS_DATA) {
@@ -265,6 +314,9 @@ int main() {
         std::cout << "Texture " << data.name << " loaded as " << textureName << ". (Block ID: " << data.blockID << ")" << std::endl;
     }
 
+    // Chunks draw all blocks from one texture array
+    GLuint blocksTextureArray = loadBlocksTextureArray();
+
     Shader *shader = Shader::load("cube");
     Shader *waterShader = Shader::load("water");
     Shader *crosshairShader = Shader::load("crosshair");
@@ -280,7 +332,7 @@ int main() {
 
     glEnable(GL_DEPTH_TEST);
 
-    ChunksRenderer chunksRenderer = ChunksRenderer(glTextures, &runtimeConfig);
+    ChunksRenderer chunksRenderer = ChunksRenderer(blocksTextureArray, &runtimeConfig);
     auto world = new World(255, &runtimeConfig);
 
     bool running = true;
@@ -436,6 +488,9 @@ int main() {
 
         // glBindVertexArray(vao);
         Vec3i playerPos = {static_cast<int>(world->player->getPosition().x), static_cast<int>(world->player->getPosition().y), static_cast<int>(world->player->getPosition().z)};
+        // Take meshes finished by bakers
+        world->publishCompletedMeshes();
+
         chunksRenderer.renderChunks(world, shader, waterShader, selectionShader, floraShader, playerPos);
 
         // Render crosshair
@@ -463,6 +518,12 @@ int main() {
                 ImGui::Text("Chunks loaded: %d", world->chunks.size());
                 ImGui::Text("Polygons rendered: %dk", (chunksRenderer.lastCountOfTotalVertices / 3) / 1000 /* (vertices / VERTICES_PER_POLYGON) / UNITS_TO_THOUSANDS */);
                 ImGui::Text("FPS: %d", stableFrameCount);
+                ImGui::Text("Bake time: %.2f ms", world->averageBakeTimeMs.load());
+                ImGui::Text("Edited while baking: %d", world->countOfStaleBakes.load());
+                ImGui::Text("Chunk tasks: %d", TaskFramePool::shared().getLiveFrames());
+                ImGui::Text("Generated, not meshed: %d/%d (stalled %.0f ms)", world->meshStage.getDepth(), world->meshStage.getCapacity(), world->meshStage.getStallMs());
+                ImGui::Text("Awaiting upload: %d/%d, %d bakes parked (stalled %.0f ms)", world->uploadStage.getDepth(), world->uploadStage.getCapacity(), world->uploadStage.getParkedCount(), world->uploadStage.getStallMs());
+                ImGui::Text("Pending uploads: %d (%zu KB last frame)", chunksRenderer.lastCountOfPendingUploads, chunksRenderer.lastCountOfUploadedBytes / 1024);
                 ImGui::Text("Seed: %d", world->seedValue);
                 ImGui::Text("Position: %d, %d, %d", playerPos.x, playerPos.y, playerPos.z);
                 ImGui::Text("Look at: %.2f, %.2f, %.2f", world->player->camera_front.x, world->player->camera_front.y, world->player->camera_front.z);
@@ -474,6 +535,22 @@ int main() {
                 ImGui::Checkbox("Generate new chunks", &runtimeConfig.isChunkGenerationEnabled);
                 ImGui::Checkbox("Bake new chunks", &runtimeConfig.isChunkBakingEnabled);
 
+                if (ImGui::BeginCombo("Mesher", world->getMesher()->getName())) {
+                    for (int i = 0; i < world->meshers.size(); i++) {
+                        if (ImGui::Selectable(world->meshers[i]->getName(), i == runtimeConfig.chunkMesher)) {
+                            runtimeConfig.chunkMesher = i;
+                            world->requestRebakeAll();
+                        }
+                    }
+                    ImGui::EndCombo();
+                }
+
+                if (ImGui::Checkbox("Light from textures", &runtimeConfig.isLightTextureEnabled)) {
+                    world->lightEngine.setVertexLightEnabled(!runtimeConfig.isLightTextureEnabled);
+                    // Meshes didn't follow light changes meanwhile
+                    if (!runtimeConfig.isLightTextureEnabled) world->requestRebakeAll();
+                }
+
                 ImGui::EndTabItem();
             }
             if (ImGui::BeginTabItem("Settings")) {
@@ -485,6 +562,10 @@ int main() {
 
                 }
 
+                ImGui::SliderInt("Upload budget (KB/frame)", &runtimeConfig.uploadBudgetKb, 64, 8192);
+                ImGui::SliderInt("Full flora density (blocks)", &runtimeConfig.floraFullDensityDistance, 0, 512);
+                ImGui::SliderFloat("Time of day (hours)", &runtimeConfig.timeOfDay, 0.0f, 24.0f);
+
                 ImGui::EndTabItem();
             }
             if (ImGui::BeginTabItem("Experiments")) {
@@ -494,14 +575,17 @@ int main() {
                         static_cast<int>(world->player->getPosition().z / CHUNK_SIZE_XZ)
                     };
 
-                    runtimeConfig.isChunkBakingEnabled = false;
+                    std::vector<Vec3i> positions;
                     for (int x = 0; x < CHUNK_SIZE_XZ; x++) {
                         for (int y = 0; y < CHUNK_SIZE_Y; y++) {
                             for (int z = 0; z < CHUNK_SIZE_XZ; z++) {
-                                    world->setBlock(BLOCK_AIR, Vec3i(playerChunkPos.x + x, playerChunkPos.y + y, playerChunkPos.z + z));
+                                positions.emplace_back(playerChunkPos.x + x, playerChunkPos.y + y, playerChunkPos.z + z);
                             }
                         }
                     }
+
+                    runtimeConfig.isChunkBakingEnabled = false;
+                    world->setBlocks(BLOCK_AIR, positions);
                     runtimeConfig.isChunkBakingEnabled = true;
                 }
 
@@ -7,6 +7,11 @@ struct RuntimeConfig {
   bool isEnableVsync;
   bool isChunkGenerationEnabled;
   bool isChunkBakingEnabled;
+  int uploadBudgetKb; // Max size of chunk meshes uploaded to the GPU per frame
+  int chunkMesher; // Index in World::meshers
+  int floraFullDensityDistance; // Blocks from the player where flora starts thinning out towards render distance
+  float timeOfDay; // Hours, scales sky light in the shaders
+  bool isLightTextureEnabled; // Shaders read light from light textures of chunks instead of vertices
 };
 
 #endif //RUNTIMECONFIG_H